@@ -0,0 +1,520 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Benchmark suite (make bench).
+//
+// Sweeps N = 4 .. 2**LogNmax over every engine and direction:
+//    complex   - FFT()                    N <= 2**FFT_LOGN_MAX
+//    large     - FFT_Large() on a pool    N >  2**FFT_LOGN_MAX
+//    complex16 - FFT16()                  N <= 2**FFT_LOGN_MAX
+//    real      - FFT_Real(), FFT_RealInverse()
+//    batch     - FFT_BatchInterleaved(), BENCH_FRAMES frames
+//    iq16      - FFT_ExecutePlanIQ16(), packed int16 pairs in, qint16 pairs out
+//    q15, f32  - FFT_ExecutePlanQ15(), FFT_ExecutePlanF32(): int16 and float samples
+// and reports, per transform (per frame for batch):
+//    ns            - wall time; the copy that restores the input is timed separately
+//                    and subtracted
+//    cycles/bfly   - time stamp counter ticks per radix-2 butterfly, N/2 * LogN per
+//                    transform (x86 only; the TSC counts at the nominal clock)
+//    MS/s          - million input samples per second
+//    SNR           - output against a double-precision reference transform, dB
+// Inputs are uniform random numbers with a fixed seed, scaled so that no engine can
+// overflow. The table goes to stdout, and the same records go to a JSON file for
+// comparison between builds.
+//
+// Usage: bench.elf [file.json [LogNmax]], defaults: bench.json, FFT_LARGE_LOGN_MAX.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "fft_cpp.h"
+#include "fft_plan.h"
+#include "fft16.h"
+#include "fft_real.h"
+#include "fft_batch.h"
+#include "fft_iq.h"
+#include "fft_type.h"
+#include "fft_large.h"
+#include "fft_pool.h"
+
+#ifndef BENCH_CFLAGS
+#define  BENCH_CFLAGS       ""
+#endif
+
+#define  BENCH_MIN_TIME     0.05    // Seconds per measurement.
+#define  BENCH_FRAMES       16      // Frames per batch call.
+#define  BENCH_AMPLITUDE    10000   // Largest input of the direct transforms.
+
+
+// One measured configuration. Run() restores the input from Src and transforms it.
+typedef struct BENCH_CASE
+{
+  const char  *Mode;
+  int          N;
+  int          LogN;
+  int          Dir;
+  int          Frames;
+  POOL        *Pool;
+
+  void        *Src[3];              // Input copies and their buffers, Bytes each.
+  void        *Dst[3];
+  size_t       Bytes;
+  int          Copies;
+  int          Exp;                 // Block exponent of FFT16().
+
+  void       (*Run)(struct BENCH_CASE *C);
+} BENCH_CASE;
+
+typedef struct
+{
+  double  Ns;
+  double  Cycles;
+  double  Msps;
+  double  Snr;
+} BENCH_RESULT;
+
+
+static uint32_t Seed = 1;
+
+static double Uniform()
+{
+  Seed = Seed * 1664525u + 1013904223u;
+  return (Seed >> 8) / 8388608.0 - 1.0;       // -1 .. 1
+}
+
+static double NowSec()
+{
+  timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static double Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return (double)__rdtsc();
+#else
+  return 0.0;
+#endif
+}
+
+// Double-precision radix-2 FFT, twiddles straight from cos/sin. Dir as Ft_Flag; not
+// scaled.
+static void RefFFT(double *Re, double *Im, int N, int Dir)
+{
+  double *Wr = (double *)malloc((N / 2 + 1) * sizeof(double));
+  double *Wi = (double *)malloc((N / 2 + 1) * sizeof(double));
+  int     i, j, k, b, Len, Half, Step;
+  double  tr, ti, ur, ui;
+
+  for(k = 0; k < N / 2; k++)
+  {
+    Wr[k] = cos(2.0 * M_PI * k / N);
+    Wi[k] = Dir * sin(2.0 * M_PI * k / N);
+  }
+
+  for(i = 1, j = 0; i < N; i++)
+  {
+    for(b = N >> 1; j & b; b >>= 1) j ^= b;
+    j ^= b;
+    if(i < j)
+    {
+      tr = Re[i]; Re[i] = Re[j]; Re[j] = tr;
+      ti = Im[i]; Im[i] = Im[j]; Im[j] = ti;
+    }
+  }
+
+  for(Len = 2; Len <= N; Len <<= 1)
+  {
+    Half = Len >> 1;
+    Step = N / Len;
+    for(i = 0; i < N; i += Len)
+      for(k = 0; k < Half; k++)
+      {
+        ur = Re[i + k + Half];
+        ui = Im[i + k + Half];
+        tr = ur * Wr[k * Step] - ui * Wi[k * Step];
+        ti = ur * Wi[k * Step] + ui * Wr[k * Step];
+        Re[i + k + Half] = Re[i + k] - tr;
+        Im[i + k + Half] = Im[i + k] - ti;
+        Re[i + k]       += tr;
+        Im[i + k]       += ti;
+      }
+  }
+
+  free(Wr);
+  free(Wi);
+}
+
+static double Snr(const double *RefR, const double *RefI, const double *R, const double *I, int Count)
+{
+  double Sig = 0.0, Err = 0.0;
+  int    k;
+
+  for(k = 0; k < Count; k++)
+  {
+    Sig += RefR[k] * RefR[k] + RefI[k] * RefI[k];
+    Err += (R[k] - RefR[k]) * (R[k] - RefR[k]) + (I[k] - RefI[k]) * (I[k] - RefI[k]);
+  }
+  if(Err == 0.0) return 999.0;
+  return 10.0 * log10(Sig / Err);
+}
+
+
+static void CopyInput(BENCH_CASE *C)
+{
+  int k;
+
+  for(k = 0; k < C->Copies; k++)
+    memcpy(C->Dst[k], C->Src[k], C->Bytes);
+}
+
+static void RunComplex(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT((qint16 *)C->Dst[0], (qint16 *)C->Dst[1], C->N, C->LogN, C->Dir);
+}
+
+static void RunLarge(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT_Large(C->Pool, (qint16 *)C->Dst[0], (qint16 *)C->Dst[1], C->N, C->LogN, C->Dir);
+}
+
+static void RunComplex16(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT16((int16_t *)C->Dst[0], (int16_t *)C->Dst[1], C->N, C->LogN, C->Dir, &C->Exp);
+}
+
+static void RunReal(BENCH_CASE *C)
+{
+  if(C->Dir == FT_DIRECT)
+  {
+    FFT_Real((const qint16 *)C->Src[2], (qint16 *)C->Dst[0], (qint16 *)C->Dst[1], C->N, C->LogN);
+    return;
+  }
+  CopyInput(C);
+  FFT_RealInverse((qint16 *)C->Dst[0], (qint16 *)C->Dst[1], (qint16 *)C->Dst[2], C->N, C->LogN);
+}
+
+static void RunIQ16(BENCH_CASE *C)
+{
+  FFT_ExecutePlanIQ16(FFT_GetPlan(C->N, C->Dir), (const int16_t *)C->Src[0], 0, (qint16 *)C->Dst[0]);
+}
+
+static void RunQ15(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT_ExecutePlanQ15(FFT_GetPlan(C->N, C->Dir), (int16_t *)C->Dst[0], (int16_t *)C->Dst[1], NULL);
+}
+
+static void RunF32(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT_ExecutePlanF32(FFT_GetPlan(C->N, C->Dir), (float *)C->Dst[0], (float *)C->Dst[1], NULL);
+}
+
+static void RunBatch(BENCH_CASE *C)
+{
+  CopyInput(C);
+  FFT_BatchInterleaved((qint16 *)C->Dst[0], (qint16 *)C->Dst[1], C->N, C->LogN, C->Dir, C->Frames);
+}
+
+// Seconds and ticks per call of Fn, repeated until BENCH_MIN_TIME has passed.
+static void TimeIt(BENCH_CASE *C, void (*Fn)(BENCH_CASE *), double *Sec, double *Tick)
+{
+  long   Reps = 1, r;
+  double t0, t1, c0, c1;
+
+  Fn(C);                                      // Warm up: plans, pages, caches.
+  for(;;)
+  {
+    t0 = NowSec();
+    c0 = Ticks();
+    for(r = 0; r < Reps; r++) Fn(C);
+    c1 = Ticks();
+    t1 = NowSec();
+    if((t1 - t0 >= BENCH_MIN_TIME) || (Reps >= (1L << 30))) break;
+    Reps *= 2;
+  }
+  *Sec  = (t1 - t0) / Reps;
+  *Tick = (c1 - c0) / Reps;
+}
+
+static void Measure(BENCH_CASE *C, BENCH_RESULT *Res)
+{
+  double Run, RunTick, Copy = 0.0, CopyTick = 0.0;
+
+  TimeIt(C, C->Run, &Run, &RunTick);
+  if(C->Copies > 0) TimeIt(C, CopyInput, &Copy, &CopyTick);
+
+  const double Per = (Run - Copy) / C->Frames;
+  const double Bfly = 0.5 * C->N * C->LogN;
+
+  Res->Ns     = Per * 1e9;
+  Res->Msps   = C->N / Per * 1e-6;
+  Res->Cycles = (Ticks() > 0.0) ? (RunTick - CopyTick) / C->Frames / Bfly : -1.0;
+}
+
+
+// Runs one (mode, N, direction), fills Res. Returns false when out of memory.
+static bool BenchOne(const char *Mode, int LogN, int Dir, POOL *Pool, BENCH_RESULT *Res)
+{
+  const int     N      = 1 << LogN;
+  const bool    Batch  = (strcmp(Mode, "batch") == 0);
+  const bool    Real   = (strcmp(Mode, "real") == 0);
+  const bool    Wide16 = (strcmp(Mode, "complex16") == 0);
+  const bool    Iq     = (strcmp(Mode, "iq16") == 0);
+  const bool    Q15    = (strcmp(Mode, "q15") == 0);
+  const bool    F32    = (strcmp(Mode, "f32") == 0);
+  const int     Frames = Batch ? BENCH_FRAMES : 1;
+  const size_t  Count  = (size_t)N * Frames;
+  const size_t  Elem   = (Wide16 || Q15) ? sizeof(int16_t) : Iq ? 2 * sizeof(qint16) :
+                         F32 ? sizeof(float) : sizeof(qint16);
+  const int     Bins   = Real ? N / 2 + 1 : N;
+  // The real direct transform computes bins 0 .. N/2 only; the rest are not compared.
+  const size_t  Compared = (Real && (Dir == FT_DIRECT)) ? (size_t)Bins : Count;
+  int           f, k;
+  size_t        n;
+
+  // Inverse transforms grow by up to N: keep the int engines inside 2**31.
+  double Amp = BENCH_AMPLITUDE;
+  if(!Wide16 && (Dir == FT_INVERSE) && (ldexp(1.0, 26 - LogN / 2) < Amp))
+    Amp = ldexp(1.0, 26 - LogN / 2);
+  // The unscaled inverse of the Q15 engine has to stay inside int16.
+  if(Q15 && (Dir == FT_INVERSE))
+    Amp = ldexp(1.0, 13 - LogN / 2);
+
+  BENCH_CASE C;
+  memset(&C, 0, sizeof(C));
+  C.Mode   = Mode;
+  C.N      = N;
+  C.LogN   = LogN;
+  C.Dir    = Dir;
+  C.Frames = Frames;
+  C.Pool   = Pool;
+  C.Bytes  = Count * Elem;
+  C.Copies = Iq ? 0 : 2;
+
+  double *RefR = (double *)calloc(Count, sizeof(double));
+  double *RefI = (double *)calloc(Count, sizeof(double));
+  double *GotR = (double *)calloc(Count, sizeof(double));
+  double *GotI = (double *)calloc(Count, sizeof(double));
+  bool    Ok   = (RefR != NULL) && (RefI != NULL) && (GotR != NULL) && (GotI != NULL);
+
+  for(k = 0; k < 3; k++)
+  {
+    C.Src[k] = calloc(Count, Elem);
+    C.Dst[k] = calloc(Count, Elem);
+    Ok       = Ok && (C.Src[k] != NULL) && (C.Dst[k] != NULL);
+  }
+  if(!Ok) goto done;
+
+  // Inputs; RefR/RefI get the same values in double.
+  if(Real && (Dir == FT_DIRECT))
+  {
+    C.Copies = 0;
+    for(n = 0; n < (size_t)N; n++)
+    {
+      ((qint16 *)C.Src[2])[n] = (qint16)floor(Amp * Uniform() + 0.5);
+      RefR[n] = ((qint16 *)C.Src[2])[n];
+    }
+  }
+  else if(Real)
+  {
+    // Hermitian spectrum: bins 0 and N/2 are real, the rest mirror into RefR/RefI.
+    for(k = 0; k < Bins; k++)
+    {
+      qint16 re = (qint16)floor(Amp * Uniform() + 0.5);
+      qint16 im = ((k == 0) || (k == N / 2)) ? 0 : (qint16)floor(Amp * Uniform() + 0.5);
+
+      ((qint16 *)C.Src[0])[k] = re;
+      ((qint16 *)C.Src[1])[k] = im;
+      RefR[k] = re;
+      RefI[k] = im;
+      if((k > 0) && (k < N / 2))
+      {
+        RefR[N - k] =  re;
+        RefI[N - k] = -im;
+      }
+    }
+  }
+  else
+  {
+    for(n = 0; n < Count; n++)
+    {
+      double re = floor(Amp * Uniform() + 0.5);
+      double im = floor(Amp * Uniform() + 0.5);
+
+      if(Wide16 || Q15)
+      {
+        ((int16_t *)C.Src[0])[n] = (int16_t)re;
+        ((int16_t *)C.Src[1])[n] = (int16_t)im;
+      }
+      else if(F32)
+      {
+        ((float *)C.Src[0])[n] = (float)re;
+        ((float *)C.Src[1])[n] = (float)im;
+      }
+      else if(Iq)
+      {
+        ((int16_t *)C.Src[0])[2 * n]     = (int16_t)re;
+        ((int16_t *)C.Src[0])[2 * n + 1] = (int16_t)im;
+      }
+      else
+      {
+        ((qint16 *)C.Src[0])[n] = (qint16)re;
+        ((qint16 *)C.Src[1])[n] = (qint16)im;
+      }
+
+      // Batch input is interleaved: sample n/Frames of frame n%Frames.
+      size_t At = Batch ? (n % Frames) * N + n / Frames : n;
+      RefR[At] = re;
+      RefI[At] = im;
+    }
+  }
+
+  C.Run = Batch ? RunBatch : Real ? RunReal : Wide16 ? RunComplex16 : Iq ? RunIQ16 :
+          Q15 ? RunQ15 : F32 ? RunF32 : (LogN > FFT_LOGN_MAX) ? RunLarge : RunComplex;
+
+  // Accuracy: one run against the reference, with the scaling of the engine.
+  C.Run(&C);
+
+  for(f = 0; f < Frames; f++)
+  {
+    RefFFT(RefR + (size_t)f * N, RefI + (size_t)f * N, N, Dir);
+    if((Dir == FT_DIRECT) && !Wide16)
+      for(n = 0; n < (size_t)N; n++)
+      {
+        RefR[(size_t)f * N + n] /= N;
+        RefI[(size_t)f * N + n] /= N;
+      }
+  }
+
+  for(n = 0; n < Compared; n++)
+  {
+    if(Wide16)
+    {
+      GotR[n] = ldexp(((int16_t *)C.Dst[0])[n], C.Exp);
+      GotI[n] = ldexp(((int16_t *)C.Dst[1])[n], C.Exp);
+    }
+    else if(Q15)
+    {
+      GotR[n] = ((int16_t *)C.Dst[0])[n];
+      GotI[n] = ((int16_t *)C.Dst[1])[n];
+    }
+    else if(F32)
+    {
+      GotR[n] = ((float *)C.Dst[0])[n];
+      GotI[n] = ((float *)C.Dst[1])[n];
+    }
+    else if(Iq)
+    {
+      GotR[n] = ((qint16 *)C.Dst[0])[2 * n];
+      GotI[n] = ((qint16 *)C.Dst[0])[2 * n + 1];
+    }
+    else if(Real && (Dir == FT_INVERSE))
+    {
+      GotR[n] = ((qint16 *)C.Dst[2])[n];
+      GotI[n] = 0.0;
+    }
+    else
+    {
+      size_t At = Batch ? (n % Frames) * N + n / Frames : n;
+      GotR[At] = ((qint16 *)C.Dst[0])[n];
+      GotI[At] = ((qint16 *)C.Dst[1])[n];
+    }
+  }
+  Res->Snr = Snr(RefR, RefI, GotR, GotI, (int)Compared);
+
+  Measure(&C, Res);
+
+done:
+  for(k = 0; k < 3; k++)
+  {
+    free(C.Src[k]);
+    free(C.Dst[k]);
+  }
+  free(RefR);
+  free(RefI);
+  free(GotR);
+  free(GotI);
+  return Ok;
+}
+
+
+int main(int argc, const char *argv[])
+{
+  const char *Path    = (argc > 1) ? argv[1] : "bench.json";
+  const int   LogNmax = (argc > 2) ? atoi(argv[2]) : FFT_LARGE_LOGN_MAX;
+  const char *Modes[] = { "complex", "complex16", "real", "batch", "iq16", "q15", "f32", "large" };
+  const int   Dirs[]  = { FT_DIRECT, FT_INVERSE };
+
+  FILE *Json = fopen(Path, "w");
+  if(Json == NULL)
+  {
+    fprintf(stderr, "bench: cannot write %s\n", Path);
+    return 1;
+  }
+
+  POOL         *Pool  = POOL_Create(0);
+  BENCH_RESULT  Res;
+  bool          First = true;
+  int           m, d, LogN;
+
+  fprintf(Json, "{\n  \"compiler\": \"%s\",\n  \"cflags\": \"%s\",\n", __VERSION__, BENCH_CFLAGS);
+  fprintf(Json, "  \"fft16_kernel\": %d,\n  \"workers\": %d,\n  \"results\": [\n",
+          FFT16_GetKernel(), POOL_Workers(Pool));
+
+  printf("%-10s %-8s %9s %7s %14s %12s %10s %9s\n",
+         "mode", "dir", "N", "frames", "ns/transform", "cycles/bfly", "MS/s", "SNR dB");
+
+  for(m = 0; m < 8; m++)
+    for(LogN = 2; LogN <= LogNmax; LogN++)
+    {
+      const bool Large = (strcmp(Modes[m], "large") == 0);
+
+      if(Large != (LogN > FFT_LOGN_MAX))          continue;
+      if(LogN > FFT_LARGE_LOGN_MAX)               continue;
+
+      for(d = 0; d < 2; d++)
+      {
+        if(!BenchOne(Modes[m], LogN, Dirs[d], Pool, &Res))
+        {
+          fprintf(stderr, "bench: out of memory at %s N=%d\n", Modes[m], 1 << LogN);
+          continue;
+        }
+
+        const char *Dir    = (Dirs[d] == FT_DIRECT) ? "direct" : "inverse";
+        const int   Frames = (strcmp(Modes[m], "batch") == 0) ? BENCH_FRAMES : 1;
+
+        printf("%-10s %-8s %9d %7d %14.1f %12.2f %10.2f %9.1f\n",
+               Modes[m], Dir, 1 << LogN, Frames, Res.Ns, Res.Cycles, Res.Msps, Res.Snr);
+
+        fprintf(Json, "%s    {\"mode\": \"%s\", \"dir\": \"%s\", \"N\": %d, \"frames\": %d, "
+                      "\"ns\": %.1f, \"cycles_per_butterfly\": ", First ? "" : ",\n",
+                Modes[m], Dir, 1 << LogN, Frames, Res.Ns);
+        if(Res.Cycles < 0.0) fprintf(Json, "null");
+        else                 fprintf(Json, "%.3f", Res.Cycles);
+        fprintf(Json, ", \"msps\": %.3f, \"snr_db\": %.2f}", Res.Msps, Res.Snr);
+        First = false;
+        fflush(stdout);
+      }
+    }
+
+  fprintf(Json, "\n  ]\n}\n");
+  fclose(Json);
+  POOL_Destroy(Pool);
+  return 0;
+}
@@ -0,0 +1,267 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// 16-bit block-floating-point FFT (see fft16.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fft16.h"
+
+
+#define  L1_NORM(re, im)   (abs(re) + abs(im))
+
+
+// Largest |re| + |im| over the frame.
+static int Peak16(const int16_t *Rdat, const int16_t *Idat, int N)
+{
+  int i, Peak = 0;
+
+  for(i = 0; i < N; i++)
+    if(L1_NORM(Rdat[i], Idat[i]) > Peak) Peak = L1_NORM(Rdat[i], Idat[i]);
+
+  return Peak;
+}
+
+// Scalar stage kernel (see FFT16_STAGE).
+static int Stage16Scalar(int16_t *Rdat, int16_t *Idat, int N, int in,
+                         const int16_t *Wr, const int16_t *Wi, int Shift)
+{
+  int g, j, Peak = 0;
+  int ar, ai, br, bi, rtq, itq, ru, iu;
+
+  for(g = 0; g < N; g += 2*in)
+  {
+    int16_t *R0 = Rdat + g, *R1 = R0 + in;
+    int16_t *I0 = Idat + g, *I1 = I0 + in;
+
+    for(j = 0; j < in; j++)
+    {
+      ar  = R0[j] >> Shift;
+      ai  = I0[j] >> Shift;
+      br  = R1[j] >> Shift;
+      bi  = I1[j] >> Shift;
+      rtq = ar - br;
+      itq = ai - bi;
+
+      // The last stage has the single twiddle 1 and needs no multiply.
+      if(in > 1)
+      {
+        ru  = Q15_MUL(rtq, Wr[j]) - Q15_MUL(itq, Wi[j]);
+        iu  = Q15_MUL(itq, Wr[j]) + Q15_MUL(rtq, Wi[j]);
+      }
+      else
+      {
+        ru  = rtq;
+        iu  = itq;
+      }
+
+      R0[j] = (int16_t)(ar + br);
+      I0[j] = (int16_t)(ai + bi);
+      R1[j] = (int16_t)ru;
+      I1[j] = (int16_t)iu;
+
+      if(L1_NORM(ar + br, ai + bi) > Peak) Peak = L1_NORM(ar + br, ai + bi);
+      if(L1_NORM(ru, iu)           > Peak) Peak = L1_NORM(ru, iu);
+    }
+  }
+
+  return (Peak > 0xFFFF) ? 0xFFFF : Peak;
+}
+
+
+static int          KernelId;      // 0 until the first FFT16_SetKernel().
+static FFT16_STAGE  KernelStage;
+
+
+bool FFT16_SetKernel(int Kernel)
+{
+  // NEON has not been run against Stage16Scalar on ARM hardware yet (see FFT16_probe),
+  // so it is only taken when asked for by name.
+  static const int  Auto[] = { FFT16_KERNEL_AVX2, FFT16_KERNEL_SSE4 };
+  FFT16_STAGE       Stage  = NULL;
+  int               k;
+
+  if(Kernel == FFT16_KERNEL_AUTO)
+  {
+    for(k = 0; (k < (int)(sizeof(Auto) / sizeof(Auto[0]))) && (Stage == NULL); k++)
+      Stage = FFT16_SimdStage(Kernel = Auto[k]);
+    if(Stage == NULL) Kernel = FFT16_KERNEL_SCALAR;
+  }
+  else if(Kernel != FFT16_KERNEL_SCALAR)
+  {
+    Stage = FFT16_SimdStage(Kernel);
+    if(Stage == NULL) return false;
+  }
+
+  __atomic_store_n(&KernelStage, Stage, __ATOMIC_RELEASE);
+  __atomic_store_n(&KernelId,   Kernel, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+int FFT16_GetKernel()
+{
+  if(__atomic_load_n(&KernelId, __ATOMIC_ACQUIRE) == 0) FFT16_SetKernel(FFT16_KERNEL_AUTO);
+
+  return __atomic_load_n(&KernelId, __ATOMIC_ACQUIRE);
+}
+
+
+bool FFT16_ExecutePlan(const FFT_PLAN *Plan, int16_t *Rdat, int16_t *Idat, int *Exp)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL) || (Exp == NULL)) return false;
+
+  const int  N = Plan->N;
+  int        i, io, in, Shift;
+  int16_t    rtp, itp;
+
+  // Vector kernels need at least two full vectors per stage.
+  FFT16_STAGE Stage = NULL;
+  if((FFT16_GetKernel() != FFT16_KERNEL_SCALAR) && (N >= 16))
+    Stage = __atomic_load_n(&KernelStage, __ATOMIC_ACQUIRE);
+  if(Stage == NULL) Stage = Stage16Scalar;
+
+  // The input is not bounded by a previous stage, so the first shift may exceed 1 bit.
+  int Peak = Peak16(Rdat, Idat, N);
+  for(Shift = 0; (Peak >> Shift) > FFT16_LIMIT; Shift++) ;
+  *Exp = 0;
+
+  for(in = N >> 1; in > 0; in >>= 1)
+  {
+    *Exp += Shift;
+    Peak  = Stage(Rdat, Idat, N, in, Plan->Wr15 + FFT_STAGE_OFFSET(N, in),
+                  Plan->Wi15 + FFT_STAGE_OFFSET(N, in), Shift);
+
+    // The bound that holds is on the modulus, which |re| + |im| only bounds from above: a
+    // butterfly a +- b*W with |W| = 1 at most doubles the largest modulus, while
+    // |re| + |im| can grow by 2*sqrt(2). Each stage is fed moduli <= FFT16_LIMIT, so its
+    // outputs stay below 2 * FFT16_LIMIT < 2**15 in every component, and one bit brings
+    // them back under FFT16_LIMIT for the next stage.
+    Shift = (Peak > FFT16_LIMIT) ? 1 : 0;
+  }
+
+  const int32_t *Rev = Plan->Rev;
+  for(i = 1; i < N - 1; i++)
+  {
+    io = Rev[i];
+    if(i < io)
+    {
+      rtp      = Rdat[io];
+      itp      = Idat[io];
+      Rdat[io] = Rdat[i];
+      Idat[io] = Idat[i];
+      Rdat[i]  = rtp;
+      Idat[i]  = itp;
+    }
+  }
+
+  return true;
+}
+
+
+bool FFT16(int16_t *Rdat, int16_t *Idat, int N, int LogN, int Ft_Flag, int *Exp)
+{
+  // parameters error check:
+  if((Rdat == NULL) || (Idat == NULL) || (Exp == NULL)) return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
+  if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return false;
+
+  const FFT_PLAN *Plan = FFT_GetPlan(N, Ft_Flag);
+  if(Plan == NULL)                                      return false;
+
+  return FFT16_ExecutePlan(Plan, Rdat, Idat, Exp);
+}
+
+
+bool FFT16_probe()
+{
+  static const int   Kernels[] = { FFT16_KERNEL_SSE4, FFT16_KERNEL_AVX2, FFT16_KERNEL_NEON };
+  static const char *Names[]   = { "sse4", "avx2", "neon" };
+  const int          Nmax      = 1 << FFT_LOGN_MAX;
+  int16_t           *Src[2], *Ref[2], *Got[2];
+  int                k, a, d, LogN, n, ExpRef, ExpGot;
+  bool               Ok = true;
+
+  for(k = 0; k < 2; k++)
+  {
+    Src[k] = (int16_t *)malloc(Nmax * sizeof(int16_t));
+    Ref[k] = (int16_t *)malloc(Nmax * sizeof(int16_t));
+    Got[k] = (int16_t *)malloc(Nmax * sizeof(int16_t));
+  }
+  if((Src[0] == NULL) || (Src[1] == NULL) || (Ref[0] == NULL) || (Ref[1] == NULL) ||
+     (Got[0] == NULL) || (Got[1] == NULL))
+  {
+    printf("FFT16: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(k = 0; k < 3; k++)
+  {
+    bool Same = true;
+
+    if(FFT16_SimdStage(Kernels[k]) == NULL)
+    {
+      printf("FFT16: %s kernel not available\n", Names[k]);
+      continue;
+    }
+
+    // Full-scale input (shifts in every stage) and small input (no shifts at first).
+    for(a = 0; (a < 2) && Same; a++)
+      for(LogN = 4; (LogN <= FFT_LOGN_MAX) && Same; LogN++)
+        for(d = 0; (d < 2) && Same; d++)
+        {
+          const int N    = 1 << LogN;
+          const int Dir  = d ? FT_INVERSE : FT_DIRECT;
+          uint32_t  Seed = 1 + LogN;
+
+          for(n = 0; n < N; n++)
+          {
+            Seed = Seed * 1664525u + 1013904223u;
+            Src[0][n] = (int16_t)(Seed >> 16) >> (a ? 8 : 0);
+            Seed = Seed * 1664525u + 1013904223u;
+            Src[1][n] = (int16_t)(Seed >> 16) >> (a ? 8 : 0);
+          }
+
+          memcpy(Ref[0], Src[0], N * sizeof(int16_t));
+          memcpy(Ref[1], Src[1], N * sizeof(int16_t));
+          memcpy(Got[0], Src[0], N * sizeof(int16_t));
+          memcpy(Got[1], Src[1], N * sizeof(int16_t));
+
+          FFT16_SetKernel(FFT16_KERNEL_SCALAR);
+          FFT16(Ref[0], Ref[1], N, LogN, Dir, &ExpRef);
+          FFT16_SetKernel(Kernels[k]);
+          FFT16(Got[0], Got[1], N, LogN, Dir, &ExpGot);
+
+          if((ExpRef != ExpGot) || memcmp(Ref[0], Got[0], N * sizeof(int16_t)) ||
+             memcmp(Ref[1], Got[1], N * sizeof(int16_t)))
+          {
+            printf("FFT16: %s kernel differs from scalar at N=%d, %s, %s input\n",
+                   Names[k], N, d ? "inverse" : "direct", a ? "small" : "full-scale");
+            Same = false;
+          }
+        }
+
+    if(Same)
+      printf("FFT16: %s kernel bit-identical to scalar, N=16..%d, both directions\n",
+             Names[k], Nmax);
+    Ok = Ok && Same;
+  }
+
+done:
+  FFT16_SetKernel(FFT16_KERNEL_AUTO);
+  for(k = 0; k < 2; k++)
+  {
+    free(Src[k]);
+    free(Ref[k]);
+    free(Got[k]);
+  }
+  return Ok;
+}
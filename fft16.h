@@ -0,0 +1,101 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// 16-bit block-floating-point FFT.
+//
+// Samples are stored as int16_t. Before each radix-2 stage the engine knows the largest
+// |re| + |im| of the data (from the input scan or from the previous stage, which tracks
+// it while writing its outputs); when it exceeds FFT16_LIMIT both butterfly operands are
+// shifted right by one bit and the block exponent is incremented. No stage can overflow
+// and no separate scaling pass is needed.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT16_H
+#define FFT16_H
+
+#include <stdint.h>
+
+#include "fft_plan.h"
+
+#define  FFT16_LIMIT     16000    // Largest |re| + |im| a stage accepts without a shift.
+
+// Stage kernels (see FFT16_SetKernel).
+#define  FFT16_KERNEL_AUTO     0   // Best kernel the CPU supports.
+#define  FFT16_KERNEL_SCALAR   1
+#define  FFT16_KERNEL_SSE4     2   // x86 SSE4.1, 8 butterflies per instruction.
+#define  FFT16_KERNEL_AVX2     3   // x86 AVX2, 16 butterflies per instruction.
+#define  FFT16_KERNEL_NEON     4   // ARM NEON, 8 butterflies per instruction.
+
+// One radix-2 DIF stage with the half-span "in" over a whole frame: both operands are
+// shifted right by Shift bits before the butterfly, the twiddles Wr/Wi are the stage
+// table of the plan. Returns the largest |re| + |im| written (saturated to 65535).
+// Every kernel produces bit-identical output.
+typedef int (*FFT16_STAGE)(int16_t *Rdat, int16_t *Idat, int N, int in,
+                           const int16_t *Wr, const int16_t *Wi, int Shift);
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT16.
+// PURPOSE:       In-place block-floating-point FFT of int16_t data.
+//
+// PARAMETERS:
+//
+//    int16_t *Rdat  [in, out] - Real part of Input and Output Data (Signal or Spectrum)
+//    int16_t *Idat  [in, out] - Imaginary part of Input and Output Data
+//    int    N       [in]      - Number of samples: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//    int    Ft_Flag [in]      - FT_DIRECT or FT_INVERSE
+//    int   *Exp     [out]     - Block exponent
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+//
+// NOTE: The output is the unnormalised transform, sum(x[n] * W**(n*k)), for both
+//       directions:   X[k] = (Rdat[k] + i*Idat[k]) * 2**(*Exp).
+//       For the scaling of FFT() (direct transform divided by N) use 2**(*Exp - LogN).
+//_________________________________________________________________________________________
+
+bool FFT16(int16_t *Rdat, int16_t *Idat, int N, int LogN, int Ft_Flag, int *Exp);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT16_ExecutePlan.
+// PURPOSE:       Same as FFT16() with a plan from FFT_GetPlan().
+//_________________________________________________________________________________________
+
+bool FFT16_ExecutePlan(const FFT_PLAN *Plan, int16_t *Rdat, int16_t *Idat, int *Exp);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT16_SetKernel.
+// PURPOSE:       Selects the stage kernel used by FFT16(). Without a call the best
+//                kernel is chosen at first use from CPUID (x86). The NEON kernel is
+//                not chosen automatically until FFT16_probe() has passed on ARM.
+//                Not meant to be called while transforms are running.
+//
+// PARAMETERS:
+//
+//    int    Kernel  [in]      - One of FFT16_KERNEL_...
+//
+// RETURN VALUE:  false if the kernel is not built in or not supported by the CPU
+//                (the previous selection is kept), true on success.
+//_________________________________________________________________________________________
+
+bool FFT16_SetKernel(int Kernel);
+
+// Kernel currently in use (FFT16_KERNEL_SCALAR ... FFT16_KERNEL_NEON).
+int  FFT16_GetKernel();
+
+// Vector stage kernel for Kernel if it is built in and the CPU supports it, else NULL.
+// Vector kernels require N >= 16. Implemented in fft16_simd.c.
+FFT16_STAGE FFT16_SimdStage(int Kernel);
+
+// Runs every vector kernel the CPU supports through FFT16_SetKernel() for N = 16 ..
+// 2**FFT_LOGN_MAX in both directions and checks output and exponent against the scalar
+// kernel bit for bit. Prints one line per kernel; false on any difference. Leaves the
+// automatic selection in place.
+bool FFT16_probe();
+
+#endif
@@ -0,0 +1,369 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Vector stage kernels of the 16-bit FFT (see FFT16_STAGE in fft16.h).
+//
+// All kernels work on the split Rdat/Idat planes. Stages with in >= vector width run one
+// butterfly per lane with the stage twiddles loaded as vectors. The last stages (in = 4,
+// 2, 1) have fewer butterflies per group than lanes, so two groups are regrouped into
+// one "a" and one "b" vector with shuffles. Products use PMULHRSW / VQRDMULH, which
+// round exactly like Q15_MUL(), so the output is bit-identical to the scalar kernel.
+//
+// x86 kernels are compiled with per-function target attributes, so the base build does
+// not need -msse4.1 / -mavx2; the CPU is checked at run time. NEON is built when the
+// compiler targets it (always on AArch64) and checked through HWCAP on 32-bit ARM.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <string.h>
+
+#include "fft16.h"
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define  SSE4_TARGET   __attribute__((target("sse4.1")))
+#define  AVX2_TARGET   __attribute__((target("avx2")))
+
+
+// 8 butterflies: (a, b) -> (a + b, (a - b) * w); accumulates |re| + |im| of the outputs.
+SSE4_TARGET static inline void Butterfly128(__m128i *ar, __m128i *ai, __m128i *br, __m128i *bi,
+                                            __m128i wr, __m128i wi, __m128i *Peak)
+{
+  __m128i qr = _mm_sub_epi16(*ar, *br);
+  __m128i qi = _mm_sub_epi16(*ai, *bi);
+
+  *ar   = _mm_add_epi16(*ar, *br);
+  *ai   = _mm_add_epi16(*ai, *bi);
+  *br   = _mm_sub_epi16(_mm_mulhrs_epi16(qr, wr), _mm_mulhrs_epi16(qi, wi));
+  *bi   = _mm_add_epi16(_mm_mulhrs_epi16(qi, wr), _mm_mulhrs_epi16(qr, wi));
+  *Peak = _mm_max_epu16(*Peak, _mm_adds_epu16(_mm_abs_epi16(*ar), _mm_abs_epi16(*ai)));
+  *Peak = _mm_max_epu16(*Peak, _mm_adds_epu16(_mm_abs_epi16(*br), _mm_abs_epi16(*bi)));
+}
+
+SSE4_TARGET static int Stage16SSE4(int16_t *Rdat, int16_t *Idat, int N, int in,
+                                   const int16_t *Wr, const int16_t *Wi, int Shift)
+{
+  const __m128i  Cnt  = _mm_cvtsi32_si128(Shift);
+  __m128i        Peak = _mm_setzero_si128();
+  __m128i        ar, ai, br, bi, wr, wi, t0, t1, t2, t3;
+  int32_t        w;
+  uint16_t       Lane[8];
+  int            g, j;
+
+#define  LOAD(p)       _mm_sra_epi16(_mm_loadu_si128((const __m128i *)(p)), Cnt)
+#define  STORE(p, x)   _mm_storeu_si128((__m128i *)(p), (x))
+
+  if(in >= 8)
+  {
+    for(g = 0; g < N; g += 2*in)
+      for(j = 0; j < in; j += 8)
+      {
+        ar = LOAD(Rdat + g + j);
+        ai = LOAD(Idat + g + j);
+        br = LOAD(Rdat + g + j + in);
+        bi = LOAD(Idat + g + j + in);
+        wr = _mm_loadu_si128((const __m128i *)(Wr + j));
+        wi = _mm_loadu_si128((const __m128i *)(Wi + j));
+        Butterfly128(&ar, &ai, &br, &bi, wr, wi, &Peak);
+        STORE(Rdat + g + j,      ar);
+        STORE(Idat + g + j,      ai);
+        STORE(Rdat + g + j + in, br);
+        STORE(Idat + g + j + in, bi);
+      }
+  }
+  else if(in == 4)
+  {
+    // Groups of 8: a = lanes 0..3, b = lanes 4..7. Two groups give one full a and b.
+    wr = _mm_loadl_epi64((const __m128i *)Wr);
+    wi = _mm_loadl_epi64((const __m128i *)Wi);
+    wr = _mm_unpacklo_epi64(wr, wr);
+    wi = _mm_unpacklo_epi64(wi, wi);
+    for(g = 0; g < N; g += 16)
+    {
+      t0 = LOAD(Rdat + g);
+      t1 = LOAD(Rdat + g + 8);
+      t2 = LOAD(Idat + g);
+      t3 = LOAD(Idat + g + 8);
+      ar = _mm_unpacklo_epi64(t0, t1);
+      br = _mm_unpackhi_epi64(t0, t1);
+      ai = _mm_unpacklo_epi64(t2, t3);
+      bi = _mm_unpackhi_epi64(t2, t3);
+      Butterfly128(&ar, &ai, &br, &bi, wr, wi, &Peak);
+      STORE(Rdat + g,     _mm_unpacklo_epi64(ar, br));
+      STORE(Rdat + g + 8, _mm_unpackhi_epi64(ar, br));
+      STORE(Idat + g,     _mm_unpacklo_epi64(ai, bi));
+      STORE(Idat + g + 8, _mm_unpackhi_epi64(ai, bi));
+    }
+  }
+  else if(in == 2)
+  {
+    // Groups of 4: the 32-bit words a0 b0 a1 b1 are reordered to a0 a1 b0 b1.
+    memcpy(&w, Wr, sizeof(w));
+    wr = _mm_set1_epi32(w);
+    memcpy(&w, Wi, sizeof(w));
+    wi = _mm_set1_epi32(w);
+    for(g = 0; g < N; g += 16)
+    {
+      t0 = _mm_shuffle_epi32(LOAD(Rdat + g),     _MM_SHUFFLE(3, 1, 2, 0));
+      t1 = _mm_shuffle_epi32(LOAD(Rdat + g + 8), _MM_SHUFFLE(3, 1, 2, 0));
+      t2 = _mm_shuffle_epi32(LOAD(Idat + g),     _MM_SHUFFLE(3, 1, 2, 0));
+      t3 = _mm_shuffle_epi32(LOAD(Idat + g + 8), _MM_SHUFFLE(3, 1, 2, 0));
+      ar = _mm_unpacklo_epi64(t0, t1);
+      br = _mm_unpackhi_epi64(t0, t1);
+      ai = _mm_unpacklo_epi64(t2, t3);
+      bi = _mm_unpackhi_epi64(t2, t3);
+      Butterfly128(&ar, &ai, &br, &bi, wr, wi, &Peak);
+      STORE(Rdat + g,     _mm_shuffle_epi32(_mm_unpacklo_epi64(ar, br), _MM_SHUFFLE(3, 1, 2, 0)));
+      STORE(Rdat + g + 8, _mm_shuffle_epi32(_mm_unpackhi_epi64(ar, br), _MM_SHUFFLE(3, 1, 2, 0)));
+      STORE(Idat + g,     _mm_shuffle_epi32(_mm_unpacklo_epi64(ai, bi), _MM_SHUFFLE(3, 1, 2, 0)));
+      STORE(Idat + g + 8, _mm_shuffle_epi32(_mm_unpackhi_epi64(ai, bi), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+  }
+  else
+  {
+    // Pairs (x0, x1) -> (x1 + x0, x0 - x1): swap neighbours and add the sign-flipped input.
+    const __m128i Sign = _mm_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1);
+
+    for(g = 0; g < N; g += 8)
+    {
+      t0 = LOAD(Rdat + g);
+      t1 = LOAD(Idat + g);
+      t0 = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(t0, 0xB1), 0xB1),
+                         _mm_sign_epi16(t0, Sign));
+      t1 = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(t1, 0xB1), 0xB1),
+                         _mm_sign_epi16(t1, Sign));
+      Peak = _mm_max_epu16(Peak, _mm_adds_epu16(_mm_abs_epi16(t0), _mm_abs_epi16(t1)));
+      STORE(Rdat + g, t0);
+      STORE(Idat + g, t1);
+    }
+  }
+
+#undef  LOAD
+#undef  STORE
+
+  _mm_storeu_si128((__m128i *)Lane, Peak);
+  for(g = 0, j = 0; j < 8; j++)
+    if(Lane[j] > g) g = Lane[j];
+  return g;
+}
+
+
+AVX2_TARGET static int Stage16AVX2(int16_t *Rdat, int16_t *Idat, int N, int in,
+                                   const int16_t *Wr, const int16_t *Wi, int Shift)
+{
+  // Stages narrower than a 256-bit vector use the 128-bit regrouping kernels.
+  if(in < 16) return Stage16SSE4(Rdat, Idat, N, in, Wr, Wi, Shift);
+
+  const __m128i  Cnt  = _mm_cvtsi32_si128(Shift);
+  __m256i        Peak = _mm256_setzero_si256();
+  __m256i        ar, ai, br, bi, wr, wi, qr, qi;
+  uint16_t       Lane[16];
+  int            g, j;
+
+#define  LOAD(p)       _mm256_sra_epi16(_mm256_loadu_si256((const __m256i *)(p)), Cnt)
+#define  STORE(p, x)   _mm256_storeu_si256((__m256i *)(p), (x))
+
+  for(g = 0; g < N; g += 2*in)
+    for(j = 0; j < in; j += 16)
+    {
+      ar   = LOAD(Rdat + g + j);
+      ai   = LOAD(Idat + g + j);
+      br   = LOAD(Rdat + g + j + in);
+      bi   = LOAD(Idat + g + j + in);
+      wr   = _mm256_loadu_si256((const __m256i *)(Wr + j));
+      wi   = _mm256_loadu_si256((const __m256i *)(Wi + j));
+      qr   = _mm256_sub_epi16(ar, br);
+      qi   = _mm256_sub_epi16(ai, bi);
+      ar   = _mm256_add_epi16(ar, br);
+      ai   = _mm256_add_epi16(ai, bi);
+      br   = _mm256_sub_epi16(_mm256_mulhrs_epi16(qr, wr), _mm256_mulhrs_epi16(qi, wi));
+      bi   = _mm256_add_epi16(_mm256_mulhrs_epi16(qi, wr), _mm256_mulhrs_epi16(qr, wi));
+      Peak = _mm256_max_epu16(Peak, _mm256_adds_epu16(_mm256_abs_epi16(ar), _mm256_abs_epi16(ai)));
+      Peak = _mm256_max_epu16(Peak, _mm256_adds_epu16(_mm256_abs_epi16(br), _mm256_abs_epi16(bi)));
+      STORE(Rdat + g + j,      ar);
+      STORE(Idat + g + j,      ai);
+      STORE(Rdat + g + j + in, br);
+      STORE(Idat + g + j + in, bi);
+    }
+
+#undef  LOAD
+#undef  STORE
+
+  _mm256_storeu_si256((__m256i *)Lane, Peak);
+  for(g = 0, j = 0; j < 16; j++)
+    if(Lane[j] > g) g = Lane[j];
+  return g;
+}
+
+#endif  // x86
+
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+
+// 8 butterflies: (a, b) -> (a + b, (a - b) * w); accumulates |re| + |im| of the outputs.
+static inline void Butterfly64(int16x8_t *ar, int16x8_t *ai, int16x8_t *br, int16x8_t *bi,
+                               int16x8_t wr, int16x8_t wi, uint16x8_t *Peak)
+{
+  int16x8_t qr = vsubq_s16(*ar, *br);
+  int16x8_t qi = vsubq_s16(*ai, *bi);
+
+  *ar   = vaddq_s16(*ar, *br);
+  *ai   = vaddq_s16(*ai, *bi);
+  *br   = vsubq_s16(vqrdmulhq_s16(qr, wr), vqrdmulhq_s16(qi, wi));
+  *bi   = vaddq_s16(vqrdmulhq_s16(qi, wr), vqrdmulhq_s16(qr, wi));
+  *Peak = vmaxq_u16(*Peak, vqaddq_u16(vreinterpretq_u16_s16(vabsq_s16(*ar)),
+                                      vreinterpretq_u16_s16(vabsq_s16(*ai))));
+  *Peak = vmaxq_u16(*Peak, vqaddq_u16(vreinterpretq_u16_s16(vabsq_s16(*br)),
+                                      vreinterpretq_u16_s16(vabsq_s16(*bi))));
+}
+
+static int Stage16NEON(int16_t *Rdat, int16_t *Idat, int N, int in,
+                       const int16_t *Wr, const int16_t *Wi, int Shift)
+{
+  const int16x8_t  Cnt  = vdupq_n_s16((int16_t)-Shift);
+  uint16x8_t       Peak = vdupq_n_u16(0);
+  int16x8_t        ar, ai, br, bi, wr, wi, t0, t1, t2, t3;
+  int32_t          w;
+  uint16_t         Lane[8];
+  int              g, j;
+
+#define  LOAD(p)       vshlq_s16(vld1q_s16(p), Cnt)
+
+  if(in >= 8)
+  {
+    for(g = 0; g < N; g += 2*in)
+      for(j = 0; j < in; j += 8)
+      {
+        ar = LOAD(Rdat + g + j);
+        ai = LOAD(Idat + g + j);
+        br = LOAD(Rdat + g + j + in);
+        bi = LOAD(Idat + g + j + in);
+        wr = vld1q_s16(Wr + j);
+        wi = vld1q_s16(Wi + j);
+        Butterfly64(&ar, &ai, &br, &bi, wr, wi, &Peak);
+        vst1q_s16(Rdat + g + j,      ar);
+        vst1q_s16(Idat + g + j,      ai);
+        vst1q_s16(Rdat + g + j + in, br);
+        vst1q_s16(Idat + g + j + in, bi);
+      }
+  }
+  else if(in == 4)
+  {
+    // Groups of 8: a = lanes 0..3, b = lanes 4..7. Two groups give one full a and b.
+    wr = vcombine_s16(vld1_s16(Wr), vld1_s16(Wr));
+    wi = vcombine_s16(vld1_s16(Wi), vld1_s16(Wi));
+    for(g = 0; g < N; g += 16)
+    {
+      t0 = LOAD(Rdat + g);
+      t1 = LOAD(Rdat + g + 8);
+      t2 = LOAD(Idat + g);
+      t3 = LOAD(Idat + g + 8);
+      ar = vcombine_s16(vget_low_s16(t0),  vget_low_s16(t1));
+      br = vcombine_s16(vget_high_s16(t0), vget_high_s16(t1));
+      ai = vcombine_s16(vget_low_s16(t2),  vget_low_s16(t3));
+      bi = vcombine_s16(vget_high_s16(t2), vget_high_s16(t3));
+      Butterfly64(&ar, &ai, &br, &bi, wr, wi, &Peak);
+      vst1q_s16(Rdat + g,     vcombine_s16(vget_low_s16(ar),  vget_low_s16(br)));
+      vst1q_s16(Rdat + g + 8, vcombine_s16(vget_high_s16(ar), vget_high_s16(br)));
+      vst1q_s16(Idat + g,     vcombine_s16(vget_low_s16(ai),  vget_low_s16(bi)));
+      vst1q_s16(Idat + g + 8, vcombine_s16(vget_high_s16(ai), vget_high_s16(bi)));
+    }
+  }
+  else if(in == 2)
+  {
+    // Groups of 4: a 2-way deinterleaving load of 32-bit words splits a and b.
+    int32x4x2_t  r, i;
+
+    memcpy(&w, Wr, sizeof(w));
+    wr = vreinterpretq_s16_s32(vdupq_n_s32(w));
+    memcpy(&w, Wi, sizeof(w));
+    wi = vreinterpretq_s16_s32(vdupq_n_s32(w));
+    for(g = 0; g < N; g += 16)
+    {
+      r  = vld2q_s32((const int32_t *)(Rdat + g));
+      i  = vld2q_s32((const int32_t *)(Idat + g));
+      ar = vshlq_s16(vreinterpretq_s16_s32(r.val[0]), Cnt);
+      br = vshlq_s16(vreinterpretq_s16_s32(r.val[1]), Cnt);
+      ai = vshlq_s16(vreinterpretq_s16_s32(i.val[0]), Cnt);
+      bi = vshlq_s16(vreinterpretq_s16_s32(i.val[1]), Cnt);
+      Butterfly64(&ar, &ai, &br, &bi, wr, wi, &Peak);
+      r.val[0] = vreinterpretq_s32_s16(ar);
+      r.val[1] = vreinterpretq_s32_s16(br);
+      i.val[0] = vreinterpretq_s32_s16(ai);
+      i.val[1] = vreinterpretq_s32_s16(bi);
+      vst2q_s32((int32_t *)(Rdat + g), r);
+      vst2q_s32((int32_t *)(Idat + g), i);
+    }
+  }
+  else
+  {
+    // Pairs: a 2-way deinterleaving load splits a and b; the twiddle is 1.
+    int16x8x2_t  r, i;
+
+    for(g = 0; g < N; g += 16)
+    {
+      r  = vld2q_s16(Rdat + g);
+      i  = vld2q_s16(Idat + g);
+      ar = vshlq_s16(r.val[0], Cnt);
+      br = vshlq_s16(r.val[1], Cnt);
+      ai = vshlq_s16(i.val[0], Cnt);
+      bi = vshlq_s16(i.val[1], Cnt);
+      r.val[0] = vaddq_s16(ar, br);
+      r.val[1] = vsubq_s16(ar, br);
+      i.val[0] = vaddq_s16(ai, bi);
+      i.val[1] = vsubq_s16(ai, bi);
+      Peak = vmaxq_u16(Peak, vqaddq_u16(vreinterpretq_u16_s16(vabsq_s16(r.val[0])),
+                                        vreinterpretq_u16_s16(vabsq_s16(i.val[0]))));
+      Peak = vmaxq_u16(Peak, vqaddq_u16(vreinterpretq_u16_s16(vabsq_s16(r.val[1])),
+                                        vreinterpretq_u16_s16(vabsq_s16(i.val[1]))));
+      vst2q_s16(Rdat + g, r);
+      vst2q_s16(Idat + g, i);
+    }
+  }
+
+#undef  LOAD
+
+  vst1q_u16(Lane, Peak);
+  for(g = 0, j = 0; j < 8; j++)
+    if(Lane[j] > g) g = Lane[j];
+  return g;
+}
+
+static bool NeonSupported()
+{
+#if defined(__arm__)
+  return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+  return true;   // Mandatory on AArch64.
+#endif
+}
+
+#endif  // NEON
+
+
+FFT16_STAGE FFT16_SimdStage(int Kernel)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if((Kernel == FFT16_KERNEL_AVX2) && __builtin_cpu_supports("avx2"))   return Stage16AVX2;
+  if((Kernel == FFT16_KERNEL_SSE4) && __builtin_cpu_supports("sse4.1")) return Stage16SSE4;
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  if((Kernel == FFT16_KERNEL_NEON) && NeonSupported())                  return Stage16NEON;
+#endif
+
+  (void)Kernel;
+  return NULL;
+}
@@ -0,0 +1,217 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Batched FFT (see fft_batch.h).
+//
+// The interleaved kernel runs exactly the arithmetic of FFT_ExecutePlanRaw() (radix-4
+// passes, a final radix-2 stage for odd LogN, the bit-reverse pass), with a loop over
+// the K frames inside each butterfly.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+
+#include "fft_batch.h"
+
+
+// Row kernels: one butterfly position for all K frames. The rows never overlap, and
+// with restrict-qualified pointers the frame loop vectorises, but only at -O3: GCC 12
+// leaves it scalar at -O2, and the builds use -O2 at most. The kernels therefore ask for
+// O3 themselves. On x86 an AVX2 clone is chosen at load time when the CPU has it.
+#if defined(__x86_64__) || defined(__i386__)
+#define  ROW_KERNEL   __attribute__((target_clones("avx2", "default"), optimize("O3")))
+#else
+#define  ROW_KERNEL   __attribute__((optimize("O3")))
+#endif
+
+ROW_KERNEL
+static void Radix4Row(qint16 *__restrict R0, qint16 *__restrict R1, qint16 *__restrict R2,
+                      qint16 *__restrict R3, qint16 *__restrict I0, qint16 *__restrict I1,
+                      qint16 *__restrict I2, qint16 *__restrict I3, int K, int Ft,
+                      int32_t w1r, int32_t w1i, int32_t w2r, int32_t w2i,
+                      int32_t w3r, int32_t w3i)
+{
+  const FFT_INT_OPS  Op;
+  int                c;
+
+  for(c = 0; c < K; c++)
+    FFT_Radix4Dif(Op, Ft, R0[c], I0[c], R1[c], I1[c], R2[c], I2[c], R3[c], I3[c],
+                  w1r, w1i, w2r, w2i, w3r, w3i);
+}
+
+ROW_KERNEL
+static void Radix2Row(qint16 *__restrict R0, qint16 *__restrict R1,
+                      qint16 *__restrict I0, qint16 *__restrict I1, int K)
+{
+  qint16 rtp, itp;
+  int    c;
+
+  for(c = 0; c < K; c++)
+  {
+    rtp   = R0[c] + R1[c];
+    itp   = I0[c] + I1[c];
+    R1[c] = R0[c] - R1[c];
+    I1[c] = I0[c] - I1[c];
+    R0[c] = rtp;
+    I0[c] = itp;
+  }
+}
+
+static void SwapRow(qint16 *__restrict R0, qint16 *__restrict R1,
+                    qint16 *__restrict I0, qint16 *__restrict I1, int K)
+{
+  qint16 rtp, itp;
+  int    c;
+
+  for(c = 0; c < K; c++)
+  {
+    rtp   = R1[c];
+    itp   = I1[c];
+    R1[c] = R0[c];
+    I1[c] = I0[c];
+    R0[c] = rtp;
+    I0[c] = itp;
+  }
+}
+
+
+bool FFT_ExecutePlanColumns(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, int K, int Stride)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+  if((K < 1) || (Stride < K))                            return false;
+
+  const int     N = Plan->N;
+  const size_t  Q = (size_t)Stride;
+  int           i, j, g, q, ie, io;
+
+  for(ie = N; ie >= 4; ie >>= 2)
+  {
+    q = ie >> 2;
+
+    const int32_t *W1r = Plan->Wr31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W1i = Plan->Wi31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W2r = Plan->Wr31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W2i = Plan->Wi31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W3r = Plan->W3r31 + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W3i = Plan->W3i31 + FFT_STAGE_OFFSET(N, 2*q);
+
+    for(g = 0; g < N; g += ie)
+      for(j = 0; j < q; j++)
+      {
+        qint16 *R0 = Rdat + (g + j) * Q;
+        qint16 *I0 = Idat + (g + j) * Q;
+
+        Radix4Row(R0, R0 + q * Q, R0 + 2 * q * Q, R0 + 3 * q * Q,
+                  I0, I0 + q * Q, I0 + 2 * q * Q, I0 + 3 * q * Q, K, Plan->Ft_Flag,
+                  W1r[j], W1i[j], W2r[j], W2i[j], W3r[j], W3i[j]);
+      }
+  }
+
+  if(ie == 2)
+    for(i = 0; i < N; i += 2)
+      Radix2Row(Rdat + i * Q, Rdat + (i + 1) * Q, Idat + i * Q, Idat + (i + 1) * Q, K);
+
+  const int32_t *Rev = Plan->Rev;
+  for(i = 1; i < N - 1; i++)
+  {
+    io = Rev[i];
+    if(i < io) SwapRow(Rdat + i * Q, Rdat + io * Q, Idat + i * Q, Idat + io * Q, K);
+  }
+
+  return true;
+}
+
+
+bool FFT_ExecutePlanBatch(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, int K)
+{
+  if(!FFT_ExecutePlanColumns(Plan, Rdat, Idat, K, K)) return false;
+  if(Plan->Ft_Flag == FT_INVERSE)                      return true;
+
+  const size_t  Count = (size_t)Plan->N * K;
+  const int     N     = Plan->N;
+  size_t        i;
+
+  for(i = 0; i < Count; i++)
+  {
+    Rdat[i] /= N;
+    Idat[i] /= N;
+  }
+
+  return true;
+}
+
+
+bool FFT_BatchInterleaved(qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag, int K)
+{
+  // parameters error check:
+  if((Rdat == NULL) || (Idat == NULL) || (K < 1))       return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
+  if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return false;
+
+  const FFT_PLAN *Plan = FFT_GetPlan(N, Ft_Flag);
+  if(Plan == NULL)                                      return false;
+
+  return FFT_ExecutePlanBatch(Plan, Rdat, Idat, K);
+}
+
+
+bool FFT_BatchPitch(qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag, int K, int Pitch)
+{
+  // parameters error check:
+  if((Rdat == NULL) || (Idat == NULL) || (K < 1))       return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
+  if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return false;
+  if(Pitch < N)                                         return false;
+
+  const FFT_PLAN *Plan = FFT_GetPlan(N, Ft_Flag);
+  if(Plan == NULL)                                      return false;
+
+  int c, t, n, Tile;
+
+  if(N > FFT_BATCH_TILE_N)
+  {
+    for(c = 0; c < K; c++)
+      FFT_ExecutePlan(Plan, Rdat + (size_t)c * Pitch, Idat + (size_t)c * Pitch);
+    return true;
+  }
+
+  qint16 TileR[FFT_BATCH_TILE_N * FFT_BATCH_TILE];
+  qint16 TileI[FFT_BATCH_TILE_N * FFT_BATCH_TILE];
+
+  for(c = 0; c < K; c += Tile)
+  {
+    Tile = (K - c < FFT_BATCH_TILE) ? (K - c) : FFT_BATCH_TILE;
+
+    for(t = 0; t < Tile; t++)
+    {
+      const qint16 *R = Rdat + (size_t)(c + t) * Pitch;
+      const qint16 *I = Idat + (size_t)(c + t) * Pitch;
+
+      for(n = 0; n < N; n++)
+      {
+        TileR[n * Tile + t] = R[n];
+        TileI[n * Tile + t] = I[n];
+      }
+    }
+
+    FFT_ExecutePlanBatch(Plan, TileR, TileI, Tile);
+
+    for(t = 0; t < Tile; t++)
+    {
+      qint16 *R = Rdat + (size_t)(c + t) * Pitch;
+      qint16 *I = Idat + (size_t)(c + t) * Pitch;
+
+      for(n = 0; n < N; n++)
+      {
+        R[n] = TileR[n * Tile + t];
+        I[n] = TileI[n * Tile + t];
+      }
+    }
+  }
+
+  return true;
+}
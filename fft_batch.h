@@ -0,0 +1,75 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Batched FFT over K frames of the same length and direction. Parameters are checked
+// and the plan is fetched once per call. Every frame gets the same result as FFT().
+//
+// Two layouts:
+//    interleaved - sample n of frame c is at Rdat[n*K + c] (channel-interleaved);
+//    pitch       - frame c starts at Rdat + c*Pitch.
+// The interleaved kernel runs the butterflies of all K frames in its innermost loop, so
+// each twiddle is loaded once per K butterflies and the loop vectorises across frames
+// (the row kernels are built at O3 whatever the build flags; an AVX2 clone is picked at
+// run time on x86); the bit-reverse pass moves rows of K samples. Small pitched frames
+// are gathered, FFT_BATCH_TILE at a time, into an interleaved block and go through the
+// same kernel.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_BATCH_H
+#define FFT_BATCH_H
+
+#include "fft_plan.h"
+
+#define  FFT_BATCH_TILE      16     // Pitched frames transformed together when small.
+#define  FFT_BATCH_TILE_N   256     // Largest N that is tiled.
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_BatchInterleaved.
+// PURPOSE:       In-place FFT of K channel-interleaved frames.
+//
+// PARAMETERS:
+//
+//    qint16 *Rdat   [in, out] - Real parts, N*K samples, Rdat[n*K + c]
+//    qint16 *Idat   [in, out] - Imaginary parts, N*K samples
+//    int    N       [in]      - Frame length: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//    int    Ft_Flag [in]      - FT_DIRECT or FT_INVERSE
+//    int    K       [in]      - Number of frames, K >= 1
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_BatchInterleaved(qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag, int K);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_BatchPitch.
+// PURPOSE:       In-place FFT of K frames placed Pitch samples apart.
+//
+// PARAMETERS:
+//
+//    qint16 *Rdat   [in, out] - Real parts, frame c at Rdat + c*Pitch
+//    qint16 *Idat   [in, out] - Imaginary parts, frame c at Idat + c*Pitch
+//    int    N       [in]      - Frame length: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//    int    Ft_Flag [in]      - FT_DIRECT or FT_INVERSE
+//    int    K       [in]      - Number of frames, K >= 1
+//    int    Pitch   [in]      - Distance between frame starts, Pitch >= N
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_BatchPitch(qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag, int K, int Pitch);
+
+// Interleaved kernel with a plan from FFT_GetPlan(); same scaling as FFT_ExecutePlan().
+bool FFT_ExecutePlanBatch(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, int K);
+
+// The kernel itself, without scaling (as FFT_ExecutePlanRaw()), on K adjacent columns of
+// a row-major matrix whose rows are Stride samples long: sample n of column c is at
+// Rdat[n*Stride + c]. Stride >= K.
+bool FFT_ExecutePlanColumns(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, int K, int Stride);
+
+#endif
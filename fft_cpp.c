@@ -22,18 +22,32 @@
 // NOTE: In this algorithm N and LogN can be only:
 //       N    = 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384;
 //       LogN = 2, 3,  4,  5,  6,   7,   8,   9,   10,   11,   12,   13,    14;
+//       N must be equal to 2**LogN.
+//       Twiddles are Q31, computed once per plan; products are rounded. N <= 256 run
+//       the compile-time specialised engine of fft_small.h instead (same results).
 //_________________________________________________________________________________________
 //_________________________________________________________________________________________
  
  
-#define  NUMBER_IS_2_POW_K(x)   ((!((x)&((x)-1)))&&((x)>1))  // x is pow(2, k), k=1,2, ...
-#define  FT_DIRECT        -1    // Direct transform.
-#define  FT_INVERSE        1    // Inverse transform.
- 
-
 #include <stddef.h>
 #include <stdio.h>
-typedef int qint16;
+#include <string.h>
+
+#include "fft_cpp.h"
+#include "fft_plan.h"
+#include "fft_small.h"
+
+// Specialised engines of the small sizes (see fft_small.h): [LogN][0 - direct, 1 - inverse].
+static void (* const SmallFFT[FFT_SMALL_LOGN_MAX + 1][2])(qint16 *, qint16 *) = {
+  { NULL,                                  NULL                                   },
+  { NULL,                                  NULL                                   },
+  { FFT_SMALL<2, FT_DIRECT>::Execute,      FFT_SMALL<2, FT_INVERSE>::Execute      },
+  { FFT_SMALL<3, FT_DIRECT>::Execute,      FFT_SMALL<3, FT_INVERSE>::Execute      },
+  { FFT_SMALL<4, FT_DIRECT>::Execute,      FFT_SMALL<4, FT_INVERSE>::Execute      },
+  { FFT_SMALL<5, FT_DIRECT>::Execute,      FFT_SMALL<5, FT_INVERSE>::Execute      },
+  { FFT_SMALL<6, FT_DIRECT>::Execute,      FFT_SMALL<6, FT_INVERSE>::Execute      },
+  { FFT_SMALL<7, FT_DIRECT>::Execute,      FFT_SMALL<7, FT_INVERSE>::Execute      },
+  { FFT_SMALL<8, FT_DIRECT>::Execute,      FFT_SMALL<8, FT_INVERSE>::Execute      } };
 
 bool  FFT(qint16 *Rdat, qint16 *Idat, qint16 N, qint16 LogN, qint16 Ft_Flag)
 {
@@ -41,95 +55,101 @@ bool  FFT(qint16 *Rdat, qint16 *Idat, qint16 N, qint16 LogN, qint16 Ft_Flag)
   if((Rdat == NULL) || (Idat == NULL))                  return false;
   if((N > 16384) || (N < 1))                            return false;
   if(!NUMBER_IS_2_POW_K(N))                             return false;
-  if((LogN < 2) || (LogN > 14))                         return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
   if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return false;
- 
-  register qint16  i, j, n, k, io, ie, in, nn;
-  qint16         ru, iu, rtp, itp, rtq, itq, rw, iw, sr;
- 
-  static const qint16 Rcoef[14] =
-  {  -127, 0, 91, 118, 126, 
-    125, 124, 123, 122, 121, 
-    120, 119, 118, 117 
-  };
-  static const qint16 Icoef[14] =
-  {   0, -127, -91, -49, -25, 
-      -14, -7, -4, -3, -2, 
-      -13, -6, -3, -2 
-  };
- 
-  nn = N >> 1;
-  ie = N;
-  for(n=1; n<=LogN; n++)
+
+  if(LogN <= FFT_SMALL_LOGN_MAX)
   {
-    rw = Rcoef[LogN - n];
-    iw = Icoef[LogN - n];
-    if(Ft_Flag == FT_INVERSE) iw = -iw;
-    in = ie >> 1;
-    ru = 1;
-    iu = 0;
-    for(j=0; j<in; j++)
+    SmallFFT[LogN][Ft_Flag == FT_INVERSE](Rdat, Idat);
+    return true;
+  }
+
+  // Twiddles and the bit-reverse table are built once per (N, Ft_Flag), see fft_plan.c.
+  const FFT_PLAN *Plan = FFT_GetPlan(N, Ft_Flag);
+  if(Plan == NULL)                                      return false;
+
+  return FFT_ExecutePlan(Plan, Rdat, Idat);
+}
+
+
+// The constexpr tables of FFT_SMALL<LogN, Ft_Flag> against the tables of its plan, all
+// N entries (the unused W3 slots and the padding are zero in both).
+template<int LogN, int Ft_Flag>
+static bool SmallTablesMatch(const FFT_PLAN *Plan)
+{
+  typedef FFT_SMALL<LogN, Ft_Flag> SMALL;
+  const size_t Size = SMALL::N * sizeof(int32_t);
+
+  return !memcmp(SMALL::T.Wr,  Plan->Wr31,  Size) && !memcmp(SMALL::T.Wi,  Plan->Wi31,  Size) &&
+         !memcmp(SMALL::T.W3r, Plan->W3r31, Size) && !memcmp(SMALL::T.W3i, Plan->W3i31, Size);
+}
+
+static bool (* const SmallTables[FFT_SMALL_LOGN_MAX + 1][2])(const FFT_PLAN *) = {
+  { NULL,                                  NULL                                   },
+  { NULL,                                  NULL                                   },
+  { SmallTablesMatch<2, FT_DIRECT>,        SmallTablesMatch<2, FT_INVERSE>        },
+  { SmallTablesMatch<3, FT_DIRECT>,        SmallTablesMatch<3, FT_INVERSE>        },
+  { SmallTablesMatch<4, FT_DIRECT>,        SmallTablesMatch<4, FT_INVERSE>        },
+  { SmallTablesMatch<5, FT_DIRECT>,        SmallTablesMatch<5, FT_INVERSE>        },
+  { SmallTablesMatch<6, FT_DIRECT>,        SmallTablesMatch<6, FT_INVERSE>        },
+  { SmallTablesMatch<7, FT_DIRECT>,        SmallTablesMatch<7, FT_INVERSE>        },
+  { SmallTablesMatch<8, FT_DIRECT>,        SmallTablesMatch<8, FT_INVERSE>        } };
+
+bool FFT_SMALL_probe()
+{
+  const int  Nmax = 1 << FFT_SMALL_LOGN_MAX;
+  qint16     Rref[Nmax], Iref[Nmax], Rgot[Nmax], Igot[Nmax];
+  int        LogN, d, n;
+
+  for(LogN = 2; LogN <= FFT_SMALL_LOGN_MAX; LogN++)
+    for(d = 0; d < 2; d++)
     {
-      for(i=j; i<N; i+=ie)
+      const int       N    = 1 << LogN;
+      const int       Dir  = d ? FT_INVERSE : FT_DIRECT;
+      const FFT_PLAN *Plan = FFT_GetPlan(N, Dir);
+      uint32_t        Seed = 1 + LogN;
+
+      if(Plan == NULL)
       {
-        io       = i + in;
-        rtp      = Rdat[i]  + Rdat[io];
-        itp      = Idat[i]  + Idat[io];
-        rtq      = Rdat[i]  - Rdat[io];
-        itq      = Idat[i]  - Idat[io];
-        Rdat[io] = rtq * ru - itq * iu;
-        Idat[io] = itq * ru + rtq * iu;
-        Rdat[i]  = rtp;
-        Idat[i]  = itp;
+        printf("FFT: no plan for N=%d\n", N);
+        return false;
+      }
+
+      if(!SmallTables[LogN][d](Plan))
+      {
+        printf("FFT: small engine tables differ from the plan at N=%d, %s\n",
+               N, d ? "inverse" : "direct");
+        return false;
+      }
+
+      for(n = 0; n < N; n++)
+      {
+        Seed = Seed * 1664525u + 1013904223u;
+        Rref[n] = Rgot[n] = (int16_t)(Seed >> 16);
+        Seed = Seed * 1664525u + 1013904223u;
+        Iref[n] = Igot[n] = (int16_t)(Seed >> 16);
+      }
+
+      FFT_ExecutePlan(Plan, Rref, Iref);
+      FFT(Rgot, Igot, N, LogN, Dir);
+
+      if(memcmp(Rref, Rgot, N * sizeof(qint16)) || memcmp(Iref, Igot, N * sizeof(qint16)))
+      {
+        printf("FFT: small engine differs from the plan at N=%d, %s\n",
+               N, d ? "inverse" : "direct");
+        return false;
       }
- 
-      sr = ru;
-      ru = ru * rw - iu * iw;
-      iu = iu * rw + sr * iw;
-    }
- 
-    ie >>= 1;
-  }
- 
-  for(j=i=1; i<N; i++)
-  {
-    if(i < j)
-    {
-      io       = i - 1;
-      in       = j - 1;
-      rtp      = Rdat[in];
-      itp      = Idat[in];
-      Rdat[in] = Rdat[io];
-      Idat[in] = Idat[io];
-      Rdat[io] = rtp;
-      Idat[io] = itp;
-    }
- 
-    k = nn;
- 
-    while(k < j)
-    {
-      j   = j - k;
-      k >>= 1;
     }
- 
-    j = j + k;
-  }
- 
-  if(Ft_Flag == FT_INVERSE) return true;
- 
-   
-  for(i=0; i<N; i++)
-  {
-    Rdat[i] /=  N;
-    Idat[i] /=  N;
-  }
- 
+
+  printf("FFT: small engine tables and output bit-identical to the plans, N=4..%d, "
+         "both directions\n", Nmax);
   return true;
 }
 
 
 
+
 void FFT_probe(){
   
   qint16 RealData[2048] = {
@@ -1,3 +1,20 @@
+#ifndef FFT_CPP_H
+#define FFT_CPP_H
+
+#define  NUMBER_IS_2_POW_K(x)   ((!((x)&((x)-1)))&&((x)>1))  // x is pow(2, k), k=1,2, ...
+#define  FT_DIRECT        -1    // Direct transform.
+#define  FT_INVERSE        1    // Inverse transform.
+#define  FFT_LOGN_MAX     14    // Largest LogN accepted by FFT() (N = 16384).
+
+typedef int qint16;
+
+bool  FFT(qint16 *Rdat, qint16 *Idat, qint16 N, qint16 LogN, qint16 Ft_Flag);
+
 void FFT_probe();
 
+// Checks the twiddle tables of the specialised engine of N <= 256 (fft_small.h) against
+// the plan tables and its output against FFT_ExecutePlan() on random input, bit for bit,
+// for every size and both directions. Prints one line; false on any difference.
+bool FFT_SMALL_probe();
 
+#endif
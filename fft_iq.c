@@ -0,0 +1,304 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Interleaved-complex int engine (see fft_iq.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fft_iq.h"
+#include "fft_order.h"
+
+
+// Loads of the first pass: packed samples are widened and scaled, qint16 ones (every
+// later pass) are taken as they are.
+static inline qint16 Widen(qint16 x, int)        { return x; }
+static inline qint16 Widen(int16_t x, int Scale) { return (qint16)x * Scale; }
+static inline qint16 Widen(int8_t x, int Scale)  { return (qint16)x * Scale; }
+
+// One radix-4 DIF pass over the span ie, the pass of FFT_ExecutePlanDif() on pairs. Src
+// is either X itself or, in the first pass, the packed input: every butterfly loads its
+// four points before it stores any.
+template<typename T>
+static void PassIQ4(const FFT_PLAN *Plan, int ie, const T *Src, int Scale, qint16 *X)
+{
+  const int          N   = Plan->N;
+  const int          Ft  = Plan->Ft_Flag;
+  const int          q   = ie >> 2;
+  const int32_t     *W1r = Plan->Wr31  + FFT_STAGE_OFFSET(N, 2*q);
+  const int32_t     *W1i = Plan->Wi31  + FFT_STAGE_OFFSET(N, 2*q);
+  const int32_t     *W2r = Plan->Wr31  + FFT_STAGE_OFFSET(N, q);
+  const int32_t     *W2i = Plan->Wi31  + FFT_STAGE_OFFSET(N, q);
+  const int32_t     *W3r = Plan->W3r31 + FFT_STAGE_OFFSET(N, 2*q);
+  const int32_t     *W3i = Plan->W3i31 + FFT_STAGE_OFFSET(N, 2*q);
+  const FFT_INT_OPS  Op;
+  int                g, j;
+  qint16             r0, i0, r1, i1, r2, i2, r3, i3;
+
+  for(g = 0; g < N; g += ie)
+  {
+    const T *S0 = Src + 2 * g, *S1 = S0 + 2 * q, *S2 = S1 + 2 * q, *S3 = S2 + 2 * q;
+    qint16  *X0 = X + 2 * g,   *X1 = X0 + 2 * q, *X2 = X1 + 2 * q, *X3 = X2 + 2 * q;
+
+    for(j = 0; j < q; j++)
+    {
+      r0  = Widen(S0[2 * j], Scale);
+      i0  = Widen(S0[2 * j + 1], Scale);
+      r1  = Widen(S1[2 * j], Scale);
+      i1  = Widen(S1[2 * j + 1], Scale);
+      r2  = Widen(S2[2 * j], Scale);
+      i2  = Widen(S2[2 * j + 1], Scale);
+      r3  = Widen(S3[2 * j], Scale);
+      i3  = Widen(S3[2 * j + 1], Scale);
+
+      FFT_Radix4Dif(Op, Ft, r0, i0, r1, i1, r2, i2, r3, i3,
+                    W1r[j], W1i[j], W2r[j], W2i[j], W3r[j], W3i[j]);
+
+      X0[2 * j]     = r0;
+      X0[2 * j + 1] = i0;
+      X1[2 * j]     = r1;
+      X1[2 * j + 1] = i1;
+      X2[2 * j]     = r2;
+      X2[2 * j + 1] = i2;
+      X3[2 * j]     = r3;
+      X3[2 * j + 1] = i3;
+    }
+  }
+}
+
+// The radix-2 stage with the half-span 1: the last one for odd LogN, the only one for N = 2.
+template<typename T>
+static void PassIQ2(int N, const T *Src, int Scale, qint16 *X)
+{
+  int     i;
+  qint16  r0, i0, r1, i1;
+
+  for(i = 0; i < 2 * N; i += 4)
+  {
+    r0       = Widen(Src[i], Scale);
+    i0       = Widen(Src[i + 1], Scale);
+    r1       = Widen(Src[i + 2], Scale);
+    i1       = Widen(Src[i + 3], Scale);
+    X[i]     = r0 + r1;
+    X[i + 1] = i0 + i1;
+    X[i + 2] = r0 - r1;
+    X[i + 3] = i0 - i1;
+  }
+}
+
+template<typename T>
+static void ExecuteIQ(const FFT_PLAN *Plan, const T *Src, int Scale, qint16 *X)
+{
+  const int  N  = Plan->N;
+  int        ie = N, i;
+
+  if(N >= 4)
+  {
+    PassIQ4(Plan, N, Src, Scale, X);
+    for(ie = N >> 2; ie >= 4; ie >>= 2)
+      PassIQ4(Plan, ie, (const qint16 *)X, 1, X);
+  }
+
+  if(ie == 2)
+  {
+    if(N == 2) PassIQ2(N, Src, Scale, X);
+    else       PassIQ2(N, (const qint16 *)X, 1, X);
+  }
+
+  FFT_BitReverseIQ(Plan, X);
+
+  if(Plan->Ft_Flag == FT_DIRECT)
+    for(i = 0; i < 2 * N; i++)
+      X[i] /= N;
+}
+
+
+bool FFT_BitReverseIQ(const FFT_PLAN *Plan, qint16 *Xdat)
+{
+  if((Plan == NULL) || (Xdat == NULL)) return false;
+
+  const int      N    = Plan->N;
+  const int      LogN = Plan->LogN;
+  const int32_t *Rev  = Plan->Rev;
+  int            i, io;
+  qint16         rtp, itp;
+
+  if(LogN < FFT_COBRA_LOGN)
+  {
+    for(i = 1; i < N - 1; i++)
+    {
+      io = Rev[i];
+      if(i < io)
+      {
+        rtp              = Xdat[2 * io];
+        itp              = Xdat[2 * io + 1];
+        Xdat[2 * io]     = Xdat[2 * i];
+        Xdat[2 * io + 1] = Xdat[2 * i + 1];
+        Xdat[2 * i]      = rtp;
+        Xdat[2 * i + 1]  = itp;
+      }
+    }
+    return true;
+  }
+
+  // The blocked permutation of FFT_BitReverse(), with rows of T pairs.
+  const int  B    = FFT_COBRA_BITS;
+  const int  T    = 1 << B;
+  const int  M    = LogN - 2 * B;
+  const int  Mid  = 1 << M;
+  int        Rt[1 << FFT_COBRA_BITS];
+  qint16     X1[2 << (2 * FFT_COBRA_BITS)];
+  qint16     X2[2 << (2 * FFT_COBRA_BITS)];
+  int        a, b, c, rb, Src, Dst;
+
+  for(a = 0; a < T; a++)
+    Rt[a] = Rev[a] >> (LogN - B);
+
+  for(b = 0; b < Mid; b++)
+  {
+    rb = Rev[b] >> (LogN - M);
+    if(rb < b) continue;
+
+    for(a = 0; a < T; a++)
+    {
+      Src = (a << (M + B)) | (b << B);
+      for(c = 0; c < 2 * T; c++)
+        X1[2 * a * T + c] = Xdat[2 * Src + c];
+      if(rb == b) continue;
+
+      Src = (a << (M + B)) | (rb << B);
+      for(c = 0; c < 2 * T; c++)
+        X2[2 * a * T + c] = Xdat[2 * Src + c];
+    }
+
+    for(a = 0; a < T; a++)
+    {
+      Dst = (a << (M + B)) | (rb << B);
+      for(c = 0; c < T; c++)
+      {
+        Xdat[2 * (Dst + c)]     = X1[2 * (Rt[c] * T + Rt[a])];
+        Xdat[2 * (Dst + c) + 1] = X1[2 * (Rt[c] * T + Rt[a]) + 1];
+      }
+      if(rb == b) continue;
+
+      Dst = (a << (M + B)) | (b << B);
+      for(c = 0; c < T; c++)
+      {
+        Xdat[2 * (Dst + c)]     = X2[2 * (Rt[c] * T + Rt[a])];
+        Xdat[2 * (Dst + c) + 1] = X2[2 * (Rt[c] * T + Rt[a]) + 1];
+      }
+    }
+  }
+
+  return true;
+}
+
+
+bool FFT_ExecutePlanIQ(const FFT_PLAN *Plan, qint16 *Xdat)
+{
+  // parameters error check:
+  if((Plan == NULL) || (Xdat == NULL))                  return false;
+
+  ExecuteIQ(Plan, (const qint16 *)Xdat, 1, Xdat);
+  return true;
+}
+
+bool FFT_ExecutePlanIQ8(const FFT_PLAN *Plan, const int8_t *Src, int Shift, qint16 *Xdat)
+{
+  // parameters error check:
+  if((Plan == NULL) || (Src == NULL) || (Xdat == NULL)) return false;
+  if((Shift < 0) || (Shift > 16))                       return false;
+
+  ExecuteIQ(Plan, Src, 1 << Shift, Xdat);
+  return true;
+}
+
+bool FFT_ExecutePlanIQ16(const FFT_PLAN *Plan, const int16_t *Src, int Shift, qint16 *Xdat)
+{
+  // parameters error check:
+  if((Plan == NULL) || (Src == NULL) || (Xdat == NULL)) return false;
+  if((Shift < 0) || (Shift > 16))                       return false;
+
+  ExecuteIQ(Plan, Src, 1 << Shift, Xdat);
+  return true;
+}
+
+
+bool FFT_IQ_probe()
+{
+  static const char *Names[4] = { "FFT_ExecutePlanIQ", "FFT_ExecutePlanIQ16",
+                                  "FFT_ExecutePlanIQ8", "FFT_ExecutePlanIQ8 << 8" };
+  const int  Nmax = 1 << FFT_LOGN_MAX;
+  int16_t   *Src16 = (int16_t *)malloc(2 * Nmax * sizeof(int16_t));
+  int8_t    *Src8  = (int8_t *)malloc(2 * Nmax * sizeof(int8_t));
+  qint16    *Xdat  = (qint16 *)malloc(2 * Nmax * sizeof(qint16));
+  qint16    *Rexp  = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Iexp  = (qint16 *)malloc(Nmax * sizeof(qint16));
+  uint32_t   Seed  = 1;
+  int        LogN, d, v, n;
+  bool       Ok = true;
+
+  if((Src16 == NULL) || (Src8 == NULL) || (Xdat == NULL) || (Rexp == NULL) || (Iexp == NULL))
+  {
+    printf("IQ: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(n = 0; n < 2 * Nmax; n++)
+  {
+    Seed     = Seed * 1664525u + 1013904223u;
+    Src16[n] = (int16_t)(Seed >> 16);
+    Src8[n]  = (int8_t)(Seed >> 24);
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+    for(d = 0; (d < 2) && Ok; d++)
+      for(v = 0; (v < 4) && Ok; v++)
+      {
+        const int       N     = 1 << LogN;
+        const FFT_PLAN *Plan  = FFT_GetPlan(N, d ? FT_INVERSE : FT_DIRECT);
+        const int       Shift = (v == 3) ? 8 : 0;
+
+        // The same samples as two planes.
+        for(n = 0; n < N; n++)
+        {
+          Rexp[n] = ((v < 2) ? Src16[2 * n]     : Src8[2 * n])     * (1 << Shift);
+          Iexp[n] = ((v < 2) ? Src16[2 * n + 1] : Src8[2 * n + 1]) * (1 << Shift);
+          Xdat[2 * n]     = Rexp[n];
+          Xdat[2 * n + 1] = Iexp[n];
+        }
+
+        bool Done = FFT_ExecutePlan(Plan, Rexp, Iexp);
+
+        if(v == 0)      Done = Done && FFT_ExecutePlanIQ(Plan, Xdat);
+        else if(v == 1) Done = Done && FFT_ExecutePlanIQ16(Plan, Src16, 0, Xdat);
+        else            Done = Done && FFT_ExecutePlanIQ8(Plan, Src8, Shift, Xdat);
+
+        for(n = 0; (n < N) && Done; n++)
+          Done = (Xdat[2 * n] == Rexp[n]) && (Xdat[2 * n + 1] == Iexp[n]);
+
+        if(!Done)
+        {
+          printf("IQ: %s differs from FFT_ExecutePlan() at N=%d, %s\n",
+                 Names[v], N, d ? "inverse" : "direct");
+          Ok = false;
+        }
+      }
+
+  if(Ok)
+    printf("IQ: qint16, int16 and int8 pairs bit-identical to FFT_ExecutePlan(), N=4..%d, "
+           "both directions\n", Nmax);
+
+done:
+  free(Src16);
+  free(Src8);
+  free(Xdat);
+  free(Rexp);
+  free(Iexp);
+  return Ok;
+}
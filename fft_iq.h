@@ -0,0 +1,71 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Interleaved-complex layout of the int engine.
+//
+// Data is N packed (re, im) pairs, X[2*n] = Re x(n) and X[2*n + 1] = Im x(n), as a DMA
+// front end delivers it. The radix-4 passes and the bit-reverse swap work on the pairs
+// directly, so neither a deinterleave copy in nor a reinterleave copy out is needed.
+// Results are bit-identical to FFT_ExecutePlan() on the same samples held as two planes.
+//
+// The packed int8 and int16 variants read the source in the first pass, widening each
+// sample to qint16 (optionally shifted left for headroom). They write the result to a
+// qint16 pair buffer, and every later pass runs in place there.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_IQ_H
+#define FFT_IQ_H
+
+#include <stdint.h>
+
+#include "fft_plan.h"
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanIQ.
+// PURPOSE:       In-place transform of Plan->N interleaved qint16 pairs, with the scaling
+//                and output order of FFT_ExecutePlan().
+//
+// PARAMETERS:
+//
+//    FFT_PLAN *Plan [in]      - Plan from FFT_GetPlan()
+//    qint16   *Xdat [in, out] - Input and Output Data, 2*N values
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanIQ(const FFT_PLAN *Plan, qint16 *Xdat);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanIQ8, FFT_ExecutePlanIQ16.
+// PURPOSE:       Transform of Plan->N packed int8 / int16 pairs into qint16 pairs. Sample
+//                x is widened to x * 2**Shift in the first pass; Shift = 0 gives the
+//                result of FFT_ExecutePlan() on the same values.
+//
+// PARAMETERS:
+//
+//    FFT_PLAN *Plan  [in]     - Plan from FFT_GetPlan()
+//    int8_t   *Src   [in]     - Input Data, 2*N values; left untouched
+//    int      Shift  [in]     - 0 .. 16
+//    qint16   *Xdat  [out]    - Output Data, 2*N values
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanIQ8(const FFT_PLAN *Plan, const int8_t *Src, int Shift, qint16 *Xdat);
+
+bool FFT_ExecutePlanIQ16(const FFT_PLAN *Plan, const int16_t *Src, int Shift, qint16 *Xdat);
+
+// Bit-reverse permutation of N pairs, the counterpart of FFT_BitReverse().
+bool FFT_BitReverseIQ(const FFT_PLAN *Plan, qint16 *Xdat);
+
+// For N = 4 .. 2**FFT_LOGN_MAX and both directions checks FFT_ExecutePlanIQ(),
+// FFT_ExecutePlanIQ16() and FFT_ExecutePlanIQ8() (Shift 0 and 8) against
+// FFT_ExecutePlan() on the same samples as two planes, bit for bit. Prints one line;
+// false on any difference.
+bool FFT_IQ_probe();
+
+#endif
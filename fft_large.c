@@ -0,0 +1,407 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Large FFT by the four-step algorithm (see fft_large.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "fft_large.h"
+#include "fft_batch.h"
+
+
+// Shared by the tasks of one FFT_Large().
+typedef struct
+{
+  const FFT_PLAN *Cols;             // N1 points.
+  const FFT_PLAN *Rows;             // N2 points.
+  qint16         *Rdat;
+  qint16         *Idat;
+  qint16         *Rtmp;             // Scratch of N points when N1 != N2, else NULL.
+  qint16         *Itmp;
+  int             N1, N2;
+  int             L1, L2;
+  int             Direct;
+  int             H;                // W(N)**e = Hi[e >> H] * Lo[e & (2**H - 1)].
+  int32_t        *LoR, *LoI;
+  int32_t        *HiR, *HiI;
+} LARGE_JOB;
+
+
+static qint16 ShiftRound(int64_t x, int s)
+{
+  return (s == 0) ? (qint16)x : (qint16)((x + ((int64_t)1 << (s - 1))) >> s);
+}
+
+// W(N)**e from the two tables. The rounded product of two entries near 1 can exceed
+// Q31_ONE, so it is saturated.
+static void Twiddle(const LARGE_JOB *Job, int e, int32_t *wr, int32_t *wi)
+{
+  const int  h = e >> Job->H;
+  const int  l = e & ((1 << Job->H) - 1);
+  int64_t    r, i;
+
+  r = ((int64_t)Job->HiR[h] * Job->LoR[l] - (int64_t)Job->HiI[h] * Job->LoI[l] + (1LL << 30)) >> 31;
+  i = ((int64_t)Job->HiI[h] * Job->LoR[l] + (int64_t)Job->HiR[h] * Job->LoI[l] + (1LL << 30)) >> 31;
+  *wr = (int32_t)((r > Q31_ONE) ? Q31_ONE : (r < -Q31_ONE) ? -Q31_ONE : r);
+  *wi = (int32_t)((i > Q31_ONE) ? Q31_ONE : (i < -Q31_ONE) ? -Q31_ONE : i);
+}
+
+static void RunTasks(POOL *Pool, int Count, POOL_TASK Task, void *Arg)
+{
+  int i;
+
+  if(Pool != NULL) POOL_Run(Pool, Count, Task, Arg);
+  else             for(i = 0; i < Count; i++) Task(Arg, i, 0);
+}
+
+// Steps 1 and 2 for FFT_LARGE_COLS columns.
+static void ColumnTask(void *Arg, int Index, int)
+{
+  const LARGE_JOB *Job   = (const LARGE_JOB *)Arg;
+  const int        N2    = Job->N2;
+  const int        C0    = Index * FFT_LARGE_COLS;
+  const int        K     = (N2 - C0 < FFT_LARGE_COLS) ? (N2 - C0) : FFT_LARGE_COLS;
+  const int        Shift = 31 + (Job->Direct ? Job->L1 : 0);
+  int              k1, c;
+  int32_t          wr, wi;
+  qint16           xr, xi;
+
+  FFT_ExecutePlanColumns(Job->Cols, Job->Rdat + C0, Job->Idat + C0, K, N2);
+
+  for(k1 = 0; k1 < Job->N1; k1++)
+  {
+    qint16 *R = Job->Rdat + (size_t)k1 * N2 + C0;
+    qint16 *I = Job->Idat + (size_t)k1 * N2 + C0;
+
+    for(c = 0; c < K; c++)
+    {
+      Twiddle(Job, (C0 + c) * k1, &wr, &wi);
+      xr = R[c];
+      xi = I[c];
+      R[c] = ShiftRound((int64_t)xr * wr - (int64_t)xi * wi, Shift);
+      I[c] = ShiftRound((int64_t)xi * wr + (int64_t)xr * wi, Shift);
+    }
+  }
+}
+
+// Step 3 for one row.
+static void RowTask(void *Arg, int Index, int)
+{
+  const LARGE_JOB *Job = (const LARGE_JOB *)Arg;
+  const int        N2  = Job->N2;
+  qint16          *R   = Job->Rdat + (size_t)Index * N2;
+  qint16          *I   = Job->Idat + (size_t)Index * N2;
+  int              n;
+
+  FFT_ExecutePlanRaw(Job->Rows, R, I);
+
+  if(Job->Direct)
+    for(n = 0; n < N2; n++)
+    {
+      R[n] = ShiftRound(R[n], Job->L2);
+      I[n] = ShiftRound(I[n], Job->L2);
+    }
+}
+
+// Step 4, N1 == N2: tile row Index swaps its tiles right of the diagonal with their
+// mirror tiles below it and transposes the diagonal tile in place.
+static void TransposeSquareTask(void *Arg, int Index, int)
+{
+  const LARGE_JOB *Job = (const LARGE_JOB *)Arg;
+  const int        N2  = Job->N2;
+  const int        T   = FFT_LARGE_TILE;
+  const int        I0  = Index * T;
+  int              J0, r, c;
+  size_t           a, b;
+  qint16           t;
+
+  for(J0 = I0; J0 < N2; J0 += T)
+    for(r = 0; r < T; r++)
+      for(c = (J0 == I0) ? r + 1 : 0; c < T; c++)
+      {
+        a            = (size_t)(I0 + r) * N2 + J0 + c;
+        b            = (size_t)(J0 + c) * N2 + I0 + r;
+        t            = Job->Rdat[a];
+        Job->Rdat[a] = Job->Rdat[b];
+        Job->Rdat[b] = t;
+        t            = Job->Idat[a];
+        Job->Idat[a] = Job->Idat[b];
+        Job->Idat[b] = t;
+      }
+}
+
+// Step 4, N2 == 2*N1: tile row Index of the N1 x N2 matrix goes to the scratch buffer,
+// transposed.
+static void TransposeTask(void *Arg, int Index, int)
+{
+  const LARGE_JOB *Job = (const LARGE_JOB *)Arg;
+  const int        N1  = Job->N1;
+  const int        N2  = Job->N2;
+  const int        T   = FFT_LARGE_TILE;
+  const int        I0  = Index * T;
+  int              J0, r, c;
+
+  for(J0 = 0; J0 < N2; J0 += T)
+    for(c = 0; c < T; c++)
+      for(r = 0; r < T; r++)
+      {
+        Job->Rtmp[(size_t)(J0 + c) * N1 + I0 + r] = Job->Rdat[(size_t)(I0 + r) * N2 + J0 + c];
+        Job->Itmp[(size_t)(J0 + c) * N1 + I0 + r] = Job->Idat[(size_t)(I0 + r) * N2 + J0 + c];
+      }
+}
+
+// Copies row Index of the scratch buffer back (rows of N2 points).
+static void CopyBackTask(void *Arg, int Index, int)
+{
+  const LARGE_JOB *Job = (const LARGE_JOB *)Arg;
+  const size_t     At  = (size_t)Index * Job->N2;
+
+  memcpy(Job->Rdat + At, Job->Rtmp + At, Job->N2 * sizeof(qint16));
+  memcpy(Job->Idat + At, Job->Itmp + At, Job->N2 * sizeof(qint16));
+}
+
+
+bool FFT_Large(POOL *Pool, qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag)
+{
+  // parameters error check:
+  if((Rdat == NULL) || (Idat == NULL))                  return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LARGE_LOGN_MAX))         return false;
+  if(N != (1 << LogN))                                  return false;
+  if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return false;
+
+  if(LogN <= FFT_LOGN_MAX)
+  {
+    const FFT_PLAN *Plan = FFT_GetPlan(N, Ft_Flag);
+    if(Plan == NULL)                                    return false;
+    return FFT_ExecutePlan(Plan, Rdat, Idat);
+  }
+
+  LARGE_JOB Job;
+
+  Job.L1     = LogN / 2;
+  Job.L2     = LogN - Job.L1;
+  Job.N1     = 1 << Job.L1;
+  Job.N2     = 1 << Job.L2;
+  Job.H      = LogN / 2;
+  Job.Direct = (Ft_Flag == FT_DIRECT);
+  Job.Rdat   = Rdat;
+  Job.Idat   = Idat;
+  Job.Cols   = FFT_GetPlan(Job.N1, Ft_Flag);
+  Job.Rows   = FFT_GetPlan(Job.N2, Ft_Flag);
+  if((Job.Cols == NULL) || (Job.Rows == NULL))          return false;
+
+  const int  Lo = 1 << Job.H;
+  const int  Hi = 1 << (LogN - Job.H);
+  int        j;
+
+  Job.LoR  = (int32_t *)malloc(Lo * sizeof(int32_t));
+  Job.LoI  = (int32_t *)malloc(Lo * sizeof(int32_t));
+  Job.HiR  = (int32_t *)malloc(Hi * sizeof(int32_t));
+  Job.HiI  = (int32_t *)malloc(Hi * sizeof(int32_t));
+  Job.Rtmp = NULL;
+  Job.Itmp = NULL;
+  if(Job.N1 != Job.N2)
+  {
+    Job.Rtmp = (qint16 *)malloc((size_t)N * sizeof(qint16));
+    Job.Itmp = (qint16 *)malloc((size_t)N * sizeof(qint16));
+  }
+
+  bool Ok = (Job.LoR != NULL) && (Job.LoI != NULL) && (Job.HiR != NULL) && (Job.HiI != NULL) &&
+            ((Job.N1 == Job.N2) || ((Job.Rtmp != NULL) && (Job.Itmp != NULL)));
+
+  if(Ok)
+  {
+    for(j = 0; j < Lo; j++)
+    {
+      Job.LoR[j] = FFT_TwiddleQ31(cos(2.0 * M_PI * j / N));
+      Job.LoI[j] = FFT_TwiddleQ31(Ft_Flag * sin(2.0 * M_PI * j / N));
+    }
+    for(j = 0; j < Hi; j++)
+    {
+      Job.HiR[j] = FFT_TwiddleQ31(cos(2.0 * M_PI * j * Lo / N));
+      Job.HiI[j] = FFT_TwiddleQ31(Ft_Flag * sin(2.0 * M_PI * j * Lo / N));
+    }
+
+    RunTasks(Pool, Job.N2 / FFT_LARGE_COLS, ColumnTask, &Job);
+    RunTasks(Pool, Job.N1, RowTask, &Job);
+
+    if(Job.N1 == Job.N2)
+      RunTasks(Pool, Job.N1 / FFT_LARGE_TILE, TransposeSquareTask, &Job);
+    else
+    {
+      RunTasks(Pool, Job.N1 / FFT_LARGE_TILE, TransposeTask, &Job);
+      RunTasks(Pool, Job.N1, CopyBackTask, &Job);
+    }
+  }
+
+  free(Job.LoR);
+  free(Job.LoI);
+  free(Job.HiR);
+  free(Job.HiI);
+  free(Job.Rtmp);
+  free(Job.Itmp);
+  return Ok;
+}
+
+
+// Double-precision radix-2 FFT for the probe, twiddles straight from cos/sin. Dir as
+// Ft_Flag; not scaled.
+static bool ProbeRefFFT(double *Re, double *Im, int N, int Dir)
+{
+  double *Wr = (double *)malloc((N / 2 + 1) * sizeof(double));
+  double *Wi = (double *)malloc((N / 2 + 1) * sizeof(double));
+  int     i, j, k, b, Len, Half, Step;
+  double  tr, ti, ur, ui;
+
+  if((Wr == NULL) || (Wi == NULL))
+  {
+    free(Wr);
+    free(Wi);
+    return false;
+  }
+
+  for(k = 0; k < N / 2; k++)
+  {
+    Wr[k] = cos(2.0 * M_PI * k / N);
+    Wi[k] = Dir * sin(2.0 * M_PI * k / N);
+  }
+
+  for(i = 1, j = 0; i < N; i++)
+  {
+    for(b = N >> 1; j & b; b >>= 1) j ^= b;
+    j ^= b;
+    if(i < j)
+    {
+      tr = Re[i]; Re[i] = Re[j]; Re[j] = tr;
+      ti = Im[i]; Im[i] = Im[j]; Im[j] = ti;
+    }
+  }
+
+  for(Len = 2; Len <= N; Len <<= 1)
+  {
+    Half = Len >> 1;
+    Step = N / Len;
+    for(i = 0; i < N; i += Len)
+      for(k = 0; k < Half; k++)
+      {
+        ur = Re[i + k + Half];
+        ui = Im[i + k + Half];
+        tr = ur * Wr[k * Step] - ui * Wi[k * Step];
+        ti = ur * Wi[k * Step] + ui * Wr[k * Step];
+        Re[i + k + Half] = Re[i + k] - tr;
+        Im[i + k + Half] = Im[i + k] - ti;
+        Re[i + k]       += tr;
+        Im[i + k]       += ti;
+      }
+  }
+
+  free(Wr);
+  free(Wi);
+  return true;
+}
+
+bool FFT_LARGE_probe()
+{
+  const int  LogNmax = FFT_LOGN_MAX + 2, Nmax = 1 << LogNmax;
+  POOL      *Pool = POOL_Create(0);
+  qint16    *Rdat = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Idat = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Rexp = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Iexp = (qint16 *)malloc(Nmax * sizeof(qint16));
+  double    *Rref = (double *)malloc(Nmax * sizeof(double));
+  double    *Iref = (double *)malloc(Nmax * sizeof(double));
+  int        LogN, d, n;
+  bool       Ok = true;
+
+  if((Rdat == NULL) || (Idat == NULL) || (Rexp == NULL) || (Iexp == NULL) ||
+     (Rref == NULL) || (Iref == NULL))
+  {
+    printf("LARGE: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(LogN = 2; (LogN <= LogNmax) && Ok; LogN++)
+    for(d = 0; (d < 2) && Ok; d++)
+    {
+      const int  N    = 1 << LogN;
+      const int  Dir  = d ? FT_INVERSE : FT_DIRECT;
+      uint32_t   Seed = 1 + LogN;
+
+      for(n = 0; n < N; n++)
+      {
+        Seed = Seed * 1664525u + 1013904223u;
+        Rdat[n] = Rexp[n] = (int16_t)(Seed >> 16);
+        Seed = Seed * 1664525u + 1013904223u;
+        Idat[n] = Iexp[n] = (int16_t)(Seed >> 16);
+        Rref[n] = Rdat[n];
+        Iref[n] = Idat[n];
+      }
+
+      if(!FFT_Large(Pool, Rdat, Idat, N, LogN, Dir))
+      {
+        printf("LARGE: transform failed at N=%d\n", N);
+        Ok = false;
+        break;
+      }
+
+      // Up to 2**FFT_LOGN_MAX: the same call as FFT().
+      if(LogN <= FFT_LOGN_MAX)
+      {
+        FFT(Rexp, Iexp, N, LogN, Dir);
+        if(memcmp(Rdat, Rexp, N * sizeof(qint16)) || memcmp(Idat, Iexp, N * sizeof(qint16)))
+        {
+          printf("LARGE: differs from FFT() at N=%d, %s\n", N, d ? "inverse" : "direct");
+          Ok = false;
+        }
+        continue;
+      }
+
+      // Above it, against double precision. The direct result is the rounded bin / N,
+      // within 1 LSB. The inverse one is not scaled, and its error grows as that of any
+      // fixed-point FFT: within sqrt(N) LSB, on an output of about 2**15 * sqrt(N).
+      const double Scale = d ? 1.0 : 1.0 / N;
+      const double Bound = d ? sqrt((double)N) : 1.0;
+
+      if(!ProbeRefFFT(Rref, Iref, N, Dir))
+      {
+        printf("LARGE: out of memory\n");
+        Ok = false;
+        break;
+      }
+
+      for(n = 0; n < N; n++)
+      {
+        double Err = fmax(fabs(Rdat[n] - Rref[n] * Scale), fabs(Idat[n] - Iref[n] * Scale));
+
+        if(Err > Bound)
+        {
+          printf("LARGE: error %.1f LSB at N=%d, %s (bound %.1f)\n",
+                 Err, N, d ? "inverse" : "direct", Bound);
+          Ok = false;
+          break;
+        }
+      }
+    }
+
+  if(Ok)
+    printf("LARGE: bit-identical to FFT() for N=4..%d, within 1 / sqrt(N) LSB of double "
+           "precision for N=%d..%d, both directions\n", 1 << FFT_LOGN_MAX, 2 << FFT_LOGN_MAX, Nmax);
+
+done:
+  POOL_Destroy(Pool);
+  free(Rdat);
+  free(Idat);
+  free(Rexp);
+  free(Iexp);
+  free(Rref);
+  free(Iref);
+  return Ok;
+}
@@ -0,0 +1,62 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Large FFT: N = 2**15 .. 2**FFT_LARGE_LOGN_MAX points by the four-step algorithm.
+//
+// The N points are an N1 x N2 row-major matrix (N1 = 2**(LogN/2), N2 = N/N1, so N2 is
+// N1 or 2*N1):
+//    1. FFT of every column (N1 points, stride N2), FFT_LARGE_COLS columns per task so
+//       that a block stays in L2;
+//    2. point (k1, n2) is multiplied by W(N)**(n2*k1) while the block is still cached;
+//    3. FFT of every row (N2 points, contiguous);
+//    4. transpose, giving bin k1 + N1*k2 at index k1 + N1*k2.
+// Both transform steps use the cached plans of N1 and N2 points. Step 4 is in place when
+// N1 == N2. Otherwise it goes through one scratch buffer of N points, the only memory
+// used besides the data. W(N)**e is the product of two tables of about sqrt(N) entries,
+// for the high and the low bits of e.
+//
+// Scaling is that of FFT(): the direct transform is divided by N (by N1 after step 2 and
+// by N2 after step 3, rounded), the inverse one is not scaled. Sizes up to 2**FFT_LOGN_MAX
+// go straight to FFT_ExecutePlan().
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_LARGE_H
+#define FFT_LARGE_H
+
+#include "fft_plan.h"
+#include "fft_pool.h"
+
+#define  FFT_LARGE_LOGN_MAX   24    // Largest N is 2**24.
+#define  FFT_LARGE_COLS       16    // Columns per task of step 1.
+#define  FFT_LARGE_TILE       32    // Transpose tile: FFT_LARGE_TILE**2 points.
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_Large.
+// PURPOSE:       In-place FFT of up to 2**FFT_LARGE_LOGN_MAX points.
+//
+// PARAMETERS:
+//
+//    POOL   *Pool   [in]      - Workers for the column, row and transpose steps;
+//                               NULL - run on the caller
+//    qint16 *Rdat   [in, out] - Real part of Input and Output Data, N samples
+//    qint16 *Idat   [in, out] - Imaginary part of Input and Output Data, N samples
+//    int    N       [in]      - Number of samples: 4, 8, ... 2**FFT_LARGE_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//    int    Ft_Flag [in]      - FT_DIRECT or FT_INVERSE
+//
+// RETURN VALUE:  false on parameter error or out of memory (data untouched), true on
+//                success.
+//_________________________________________________________________________________________
+
+bool FFT_Large(POOL *Pool, qint16 *Rdat, qint16 *Idat, int N, int LogN, int Ft_Flag);
+
+// Runs FFT_Large() on random input in both directions: bit for bit against FFT() up to
+// 2**FFT_LOGN_MAX, and for the next two sizes (odd and even LogN) against a double
+// precision FFT, within 1 LSB (direct) and sqrt(N) LSB (inverse). Prints one line;
+// false on any failure.
+bool FFT_LARGE_probe();
+
+#endif
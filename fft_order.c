@@ -0,0 +1,397 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Output order of the int engine (see fft_order.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "fft_order.h"
+
+
+static void DivideByN(int N, qint16 *Rdat, qint16 *Idat)
+{
+  int i;
+
+  for(i = 0; i < N; i++)
+  {
+    Rdat[i] /= N;
+    Idat[i] /= N;
+  }
+}
+
+
+bool FFT_BitReverse(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+
+  const int      N    = Plan->N;
+  const int      LogN = Plan->LogN;
+  const int32_t *Rev  = Plan->Rev;
+  int            i, io;
+  qint16         rtp, itp;
+
+  if(LogN < FFT_COBRA_LOGN)
+  {
+    for(i = 1; i < N - 1; i++)
+    {
+      io = Rev[i];
+      if(i < io)
+      {
+        rtp      = Rdat[io];
+        itp      = Idat[io];
+        Rdat[io] = Rdat[i];
+        Idat[io] = Idat[i];
+        Rdat[i]  = rtp;
+        Idat[i]  = itp;
+      }
+    }
+    return true;
+  }
+
+  // Index i = (a, b, c): a - top B bits, b - middle M bits, c - low B bits, so that
+  // bitreverse(i) = (rev(c), rev(b), rev(a)). Tiles b and rev(b) are copied row by row
+  // (rows are runs of T points) into buffers and written back transposed and reversed.
+  const int  B    = FFT_COBRA_BITS;
+  const int  T    = 1 << B;
+  const int  M    = LogN - 2 * B;
+  const int  Mid  = 1 << M;
+  int        Rt[1 << FFT_COBRA_BITS];
+  qint16     R1[1 << (2 * FFT_COBRA_BITS)], I1[1 << (2 * FFT_COBRA_BITS)];
+  qint16     R2[1 << (2 * FFT_COBRA_BITS)], I2[1 << (2 * FFT_COBRA_BITS)];
+  int        a, b, c, rb, Src, Dst;
+
+  for(a = 0; a < T; a++)
+    Rt[a] = Rev[a] >> (LogN - B);
+
+  for(b = 0; b < Mid; b++)
+  {
+    rb = Rev[b] >> (LogN - M);
+    if(rb < b) continue;
+
+    for(a = 0; a < T; a++)
+    {
+      Src = (a << (M + B)) | (b << B);
+      for(c = 0; c < T; c++)
+      {
+        R1[a * T + c] = Rdat[Src + c];
+        I1[a * T + c] = Idat[Src + c];
+      }
+      if(rb == b) continue;
+
+      Src = (a << (M + B)) | (rb << B);
+      for(c = 0; c < T; c++)
+      {
+        R2[a * T + c] = Rdat[Src + c];
+        I2[a * T + c] = Idat[Src + c];
+      }
+    }
+
+    // Point (a, rb, c) receives (rev(c), b, rev(a)), and (a, b, c) receives (rev(c), rb, rev(a)).
+    for(a = 0; a < T; a++)
+    {
+      Dst = (a << (M + B)) | (rb << B);
+      for(c = 0; c < T; c++)
+      {
+        Rdat[Dst + c] = R1[Rt[c] * T + Rt[a]];
+        Idat[Dst + c] = I1[Rt[c] * T + Rt[a]];
+      }
+      if(rb == b) continue;
+
+      Dst = (a << (M + B)) | (b << B);
+      for(c = 0; c < T; c++)
+      {
+        Rdat[Dst + c] = R2[Rt[c] * T + Rt[a]];
+        Idat[Dst + c] = I2[Rt[c] * T + Rt[a]];
+      }
+    }
+  }
+
+  return true;
+}
+
+
+// Stockham radix-4 pass over sub-transforms of length n (m = n/4) interleaved with the
+// stride s: the same butterflies as a DIF pass of FFT_ExecutePlanDif(), with output r of
+// butterfly p stored at q + s*(4p + r). X may equal Y only for n == 4.
+static void StockhamPass4(const FFT_PLAN *Plan, int n, int s, const qint16 *Xr,
+                          const qint16 *Xi, qint16 *Yr, qint16 *Yi)
+{
+  const int          N  = Plan->N;
+  const int          Ft = Plan->Ft_Flag;
+  const int          m  = n >> 2;
+  const int32_t     *W1r = Plan->Wr31  + FFT_STAGE_OFFSET(N, 2*m);
+  const int32_t     *W1i = Plan->Wi31  + FFT_STAGE_OFFSET(N, 2*m);
+  const int32_t     *W2r = Plan->Wr31  + FFT_STAGE_OFFSET(N, m);
+  const int32_t     *W2i = Plan->Wi31  + FFT_STAGE_OFFSET(N, m);
+  const int32_t     *W3r = Plan->W3r31 + FFT_STAGE_OFFSET(N, 2*m);
+  const int32_t     *W3i = Plan->W3i31 + FFT_STAGE_OFFSET(N, 2*m);
+  const FFT_INT_OPS  Op;
+  int                p, q;
+  qint16             r0, i0, r1, i1, r2, i2, r3, i3;
+
+  for(p = 0; p < m; p++)
+  {
+    const int32_t w1r = W1r[p], w1i = W1i[p];        // The same for every column q.
+    const int32_t w2r = W2r[p], w2i = W2i[p];
+    const int32_t w3r = W3r[p], w3i = W3i[p];
+    const qint16 *R0 = Xr + s * p, *R1 = R0 + s * m, *R2 = R1 + s * m, *R3 = R2 + s * m;
+    const qint16 *I0 = Xi + s * p, *I1 = I0 + s * m, *I2 = I1 + s * m, *I3 = I2 + s * m;
+    qint16       *Y0 = Yr + s * 4 * p, *Y1 = Y0 + s, *Y2 = Y1 + s, *Y3 = Y2 + s;
+    qint16       *Z0 = Yi + s * 4 * p, *Z1 = Z0 + s, *Z2 = Z1 + s, *Z3 = Z2 + s;
+
+    for(q = 0; q < s; q++)
+    {
+      r0    = R0[q];
+      i0    = I0[q];
+      r1    = R1[q];
+      i1    = I1[q];
+      r2    = R2[q];
+      i2    = I2[q];
+      r3    = R3[q];
+      i3    = I3[q];
+
+      FFT_Radix4Dif(Op, Ft, r0, i0, r1, i1, r2, i2, r3, i3,
+                    w1r, w1i, w2r, w2i, w3r, w3i);
+
+      // Output r = 1 is x2' and r = 2 is x1', which the in-place pass leaves bit-reversed.
+      Y0[q] = r0;
+      Z0[q] = i0;
+      Y2[q] = r1;
+      Z2[q] = i1;
+      Y1[q] = r2;
+      Z1[q] = i2;
+      Y3[q] = r3;
+      Z3[q] = i3;
+    }
+  }
+}
+
+// The radix-2 pass of length 2 (twiddle 1), s = N/2. X may equal Y.
+static void StockhamPass2(int s, const qint16 *Xr, const qint16 *Xi, qint16 *Yr, qint16 *Yi)
+{
+  qint16 rtp, itp, rtq, itq;
+  int    q;
+
+  for(q = 0; q < s; q++)
+  {
+    rtp       = Xr[q];
+    itp       = Xi[q];
+    rtq       = Xr[q + s];
+    itq       = Xi[q + s];
+    Yr[q]     = rtp + rtq;
+    Yi[q]     = itp + itq;
+    Yr[q + s] = rtp - rtq;
+    Yi[q + s] = itp - itq;
+  }
+}
+
+
+bool FFT_ExecutePlanStockham(const FFT_PLAN *Plan, qint16 *Rsrc, qint16 *Isrc,
+                             qint16 *Rdst, qint16 *Idst)
+{
+  if((Plan == NULL) || (Rsrc == NULL) || (Isrc == NULL))  return false;
+  if((Rdst == NULL) || (Idst == NULL) || (Plan->LogN < 1)) return false;
+
+  const int  N      = Plan->N;
+  const int  Passes = (Plan->LogN + 1) / 2;
+  qint16    *Xr = Rsrc, *Xi = Isrc, *Yr = Rdst, *Yi = Idst, *t;
+  int        n, s, k;
+
+  // The last pass (n == 4 or n == 2) only mixes points of the same column q, so it can
+  // run in place. Doing that when the pass count is even leaves the result in Rdst.
+  for(n = N, s = 1, k = 1; n >= 4; n >>= 2, s <<= 2, k++)
+  {
+    if((n == 4) && (Passes % 2 == 0))
+    {
+      StockhamPass4(Plan, n, s, Xr, Xi, Xr, Xi);
+      break;
+    }
+
+    StockhamPass4(Plan, n, s, Xr, Xi, Yr, Yi);
+    t = Xr; Xr = Yr; Yr = t;
+    t = Xi; Xi = Yi; Yi = t;
+  }
+
+  if(n == 2)
+  {
+    if(Passes % 2 == 0) StockhamPass2(s, Xr, Xi, Xr, Xi);
+    else                StockhamPass2(s, Xr, Xi, Yr, Yi);
+  }
+
+  if(Plan->Ft_Flag == FT_DIRECT) DivideByN(N, Rdst, Idst);
+  return true;
+}
+
+
+bool FFT_ExecutePlanBitRev(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+
+  if(Plan->Ft_Flag == FT_DIRECT)
+  {
+    FFT_ExecutePlanDif(Plan, Rdat, Idat);
+    DivideByN(Plan->N, Rdat, Idat);
+    return true;
+  }
+
+  // Inverse: the DIF passes transposed, in reverse order (decimation in time, see
+  // FFT_Radix4Dit).
+  const int          N  = Plan->N;
+  const int          Ft = Plan->Ft_Flag;
+  const FFT_INT_OPS  Op;
+  int                i, j, g, q, ie;
+  qint16             rts, its;
+
+  if(Plan->LogN & 1)
+  {
+    for(i = 0; i < N; i += 2)
+    {
+      rts       = Rdat[i] + Rdat[i + 1];
+      its       = Idat[i] + Idat[i + 1];
+      Rdat[i+1] = Rdat[i] - Rdat[i + 1];
+      Idat[i+1] = Idat[i] - Idat[i + 1];
+      Rdat[i]   = rts;
+      Idat[i]   = its;
+    }
+  }
+
+  for(ie = (Plan->LogN & 1) ? 8 : 4; ie <= N; ie <<= 2)
+  {
+    q = ie >> 2;
+
+    const int32_t *W1r = Plan->Wr31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W1i = Plan->Wi31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W2r = Plan->Wr31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W2i = Plan->Wi31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W3r = Plan->W3r31 + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W3i = Plan->W3i31 + FFT_STAGE_OFFSET(N, 2*q);
+
+    for(g = 0; g < N; g += ie)
+    {
+      qint16 *R0 = Rdat + g, *R1 = R0 + q, *R2 = R1 + q, *R3 = R2 + q;
+      qint16 *I0 = Idat + g, *I1 = I0 + q, *I2 = I1 + q, *I3 = I2 + q;
+
+      for(j = 0; j < q; j++)
+        FFT_Radix4Dit(Op, Ft, R0[j], I0[j], R1[j], I1[j], R2[j], I2[j], R3[j], I3[j],
+                      W1r[j], W1i[j], W2r[j], W2i[j], W3r[j], W3i[j]);
+    }
+  }
+
+  return true;
+}
+
+
+bool FFT_ORDER_probe()
+{
+  const int  Nmax = 1 << FFT_LOGN_MAX;
+  qint16    *Buf  = (qint16 *)malloc((size_t)8 * Nmax * sizeof(qint16));
+  qint16    *Rref = Buf,            *Iref = Buf + Nmax;       // Input.
+  qint16    *Rexp = Buf + 2 * Nmax, *Iexp = Buf + 3 * Nmax;   // FFT_ExecutePlan().
+  qint16    *Rsrc = Buf + 4 * Nmax, *Isrc = Buf + 5 * Nmax;
+  qint16    *Rdst = Buf + 6 * Nmax, *Idst = Buf + 7 * Nmax;
+  uint32_t   Seed = 1;
+  int        LogN, d, n, Err, ErrMax = 0;
+  bool       Ok = true;
+
+  if(Buf == NULL)
+  {
+    printf("ORDER: out of memory\n");
+    return false;
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+  {
+    const int       N       = 1 << LogN;
+    const FFT_PLAN *Direct  = FFT_GetPlan(N, FT_DIRECT);
+    const FFT_PLAN *Inverse = FFT_GetPlan(N, FT_INVERSE);
+    const size_t    Size    = N * sizeof(qint16);
+
+    // The direct transform truncates every bin after the division by N, and the inverse
+    // one adds up N such errors of either sign: about sqrt(N) LSB.
+    const int       Bound   = (int)(4.0 * sqrt((double)N)) + 2;
+
+    if((Direct == NULL) || (Inverse == NULL))
+    {
+      printf("ORDER: no plan for N=%d\n", N);
+      Ok = false;
+      break;
+    }
+
+    for(n = 0; n < N; n++)
+    {
+      Seed = Seed * 1664525u + 1013904223u;
+      Rref[n] = (int16_t)(Seed >> 16);
+      Seed = Seed * 1664525u + 1013904223u;
+      Iref[n] = (int16_t)(Seed >> 16);
+    }
+
+    // Stockham, both directions.
+    for(d = 0; (d < 2) && Ok; d++)
+    {
+      const FFT_PLAN *Plan = d ? Inverse : Direct;
+
+      memcpy(Rsrc, Rref, Size);
+      memcpy(Isrc, Iref, Size);
+      memcpy(Rexp, Rref, Size);
+      memcpy(Iexp, Iref, Size);
+      FFT_ExecutePlan(Plan, Rexp, Iexp);
+      FFT_ExecutePlanStockham(Plan, Rsrc, Isrc, Rdst, Idst);
+
+      if(memcmp(Rdst, Rexp, Size) || memcmp(Idst, Iexp, Size))
+      {
+        printf("ORDER: Stockham differs from FFT_ExecutePlan() at N=%d, %s\n",
+               N, d ? "inverse" : "direct");
+        Ok = false;
+      }
+    }
+    if(!Ok) break;
+
+    // Bit-reversed direct transform, then the reorder pass.
+    memcpy(Rsrc, Rref, Size);
+    memcpy(Isrc, Iref, Size);
+    memcpy(Rexp, Rref, Size);
+    memcpy(Iexp, Iref, Size);
+    FFT_ExecutePlan(Direct, Rexp, Iexp);
+    FFT_ExecutePlanBitRev(Direct, Rsrc, Isrc);
+    memcpy(Rdst, Rsrc, Size);
+    memcpy(Idst, Isrc, Size);
+    FFT_BitReverse(Direct, Rdst, Idst);
+
+    if(memcmp(Rdst, Rexp, Size) || memcmp(Idst, Iexp, Size))
+    {
+      printf("ORDER: bit-reversed spectrum differs from FFT_ExecutePlan() at N=%d\n", N);
+      Ok = false;
+      break;
+    }
+
+    // And back through the bit-reversed inverse transform.
+    FFT_ExecutePlanBitRev(Inverse, Rsrc, Isrc);
+
+    for(n = 0; n < N; n++)
+    {
+      Err    = abs(Rsrc[n] - Rref[n]);
+      Err    = (abs(Isrc[n] - Iref[n]) > Err) ? abs(Isrc[n] - Iref[n]) : Err;
+      ErrMax = (Err > ErrMax) ? Err : ErrMax;
+      if(Err > Bound)
+      {
+        printf("ORDER: bit-reversed round trip off by %d LSB at N=%d (bound %d)\n",
+               Err, N, Bound);
+        Ok = false;
+        break;
+      }
+    }
+  }
+
+  if(Ok)
+    printf("ORDER: Stockham and bit-reversed spectra bit-identical to FFT_ExecutePlan(), "
+           "round trip within 4*sqrt(N)+2 LSB (worst %d), N=4..%d\n", ErrMax, Nmax);
+
+  free(Buf);
+  return Ok;
+}
@@ -0,0 +1,88 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Output order of the int engine. The radix-4 DIF passes of FFT_ExecutePlanRaw() leave
+// the spectrum bit-reversed. This module has three ways of dealing with that:
+//
+//    FFT_BitReverse()          - the reorder pass itself. Large N use a blocked (COBRA)
+//                                permutation: rows of a 2**b x 2**b tile are read and
+//                                written in cache-line runs, and the scattering happens
+//                                inside the tile in L1.
+//    FFT_ExecutePlanStockham() - out-of-place Stockham autosort: each pass writes its
+//                                outputs in sorted position, so no reorder pass is run.
+//    FFT_ExecutePlanBitRev()   - no reorder at all. The direct transform leaves the
+//                                spectrum bit-reversed, and the inverse transform (DIT,
+//                                the transpose of the DIF passes) takes it back. For
+//                                convolution and correlation, where the spectrum is only
+//                                multiplied pointwise.
+//
+// FFT_BitReverse() and FFT_ExecutePlanStockham() give results bit-identical to
+// FFT_ExecutePlan(). So does the direct transform of FFT_ExecutePlanBitRev(), apart from
+// the order of the spectrum. Its inverse transform rounds the twiddle products at other
+// points of the butterfly (DIT), so it agrees with FFT_ExecutePlan() only to within
+// rounding.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_ORDER_H
+#define FFT_ORDER_H
+
+#include "fft_plan.h"
+
+#define  FFT_COBRA_BITS      4    // Tile of the blocked permutation: 2**b x 2**b points.
+#define  FFT_COBRA_LOGN     10    // Smallest LogN that uses the blocked permutation.
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_BitReverse.
+// PURPOSE:       In-place permutation x[i] <-> x[bitreverse(i)] of Plan->N points.
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_BitReverse(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanStockham.
+// PURPOSE:       Out-of-place transform in natural order with the scaling of
+//                FFT_ExecutePlan(). The passes alternate between the two buffers,
+//                starting with Rsrc -> Rdst. When their number is even, the last pass,
+//                which only mixes points of one column, runs in place in Rdst/Idst, so
+//                the result always ends in Rdst/Idst.
+//
+// PARAMETERS:
+//
+//    FFT_PLAN *Plan [in]      - Plan from FFT_GetPlan()
+//    qint16   *Rsrc [in]      - Real part of the input, Plan->N samples; destroyed
+//    qint16   *Isrc [in]      - Imaginary part of the input; destroyed
+//    qint16   *Rdst [out]     - Real part of the result, Plan->N samples
+//    qint16   *Idst [out]     - Imaginary part of the result
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanStockham(const FFT_PLAN *Plan, qint16 *Rsrc, qint16 *Isrc,
+                             qint16 *Rdst, qint16 *Idst);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanBitRev.
+// PURPOSE:       In-place transform with the spectrum in bit-reversed order: bin k is at
+//                index bitreverse(k). A direct plan takes a natural-order signal, and its
+//                result is divided by N. An inverse plan takes a bit-reversed spectrum,
+//                gives a natural-order signal and does not scale.
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanBitRev(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat);
+
+// For N = 4 .. 2**FFT_LOGN_MAX checks FFT_ExecutePlanStockham() (both directions) and
+// FFT_BitReverse() of the direct FFT_ExecutePlanBitRev() against FFT_ExecutePlan(), bit
+// for bit, and the bit-reversed round trip against the input within 4*sqrt(N) + 2 LSB.
+// Prints one line; false on any failure.
+bool FFT_ORDER_probe();
+
+#endif
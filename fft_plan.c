@@ -0,0 +1,208 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// FFT plans and the process-wide plan cache (see fft_plan.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "fft_plan.h"
+#include "fft_order.h"
+#include "fft_type.h"
+
+
+// Cache slots: [LogN][0 - direct, 1 - inverse]. A slot is written once, under PlanLock,
+// and read without locking (acquire load pairs with the release store).
+static FFT_PLAN        *PlanCache[FFT_LOGN_MAX + 1][2];
+static pthread_mutex_t  PlanLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+int32_t FFT_TwiddleQ31(double x)
+{
+  double v = floor(x * 2147483648.0 + 0.5);
+
+  if(v >  (double)Q31_ONE) v =  (double)Q31_ONE;
+  if(v < -(double)Q31_ONE) v = -(double)Q31_ONE;
+  return (int32_t)v;
+}
+
+static int16_t TwiddleQ15(double x)
+{
+  double v = floor(x * 32768.0 + 0.5);
+
+  if(v >  (double)Q15_ONE) v =  (double)Q15_ONE;
+  if(v < -(double)Q15_ONE) v = -(double)Q15_ONE;
+  return (int16_t)v;
+}
+
+static void DestroyPlan(FFT_PLAN *Plan)
+{
+  if(Plan == NULL) return;
+  free(Plan->Wr31);
+  free(Plan->Wi31);
+  free(Plan->Wr15);
+  free(Plan->Wi15);
+  free(Plan->W3r31);
+  free(Plan->W3i31);
+  free(Plan->W3r15);
+  free(Plan->W3i15);
+  free(Plan->WrF);
+  free(Plan->WiF);
+  free(Plan->W3rF);
+  free(Plan->W3iF);
+  free(Plan->Rev);
+  free(Plan);
+}
+
+static FFT_PLAN *CreatePlan(int N, int LogN, int Ft_Flag)
+{
+  FFT_PLAN *Plan = (FFT_PLAN *)calloc(1, sizeof(FFT_PLAN));
+  if(Plan == NULL) return NULL;
+
+  Plan->N       = N;
+  Plan->LogN    = LogN;
+  Plan->Ft_Flag = Ft_Flag;
+  Plan->Wr31    = (int32_t *)malloc(N * sizeof(int32_t));
+  Plan->Wi31    = (int32_t *)malloc(N * sizeof(int32_t));
+  Plan->Wr15    = (int16_t *)malloc(N * sizeof(int16_t));
+  Plan->Wi15    = (int16_t *)malloc(N * sizeof(int16_t));
+  Plan->W3r31   = (int32_t *)calloc(N, sizeof(int32_t));
+  Plan->W3i31   = (int32_t *)calloc(N, sizeof(int32_t));
+  Plan->W3r15   = (int16_t *)calloc(N, sizeof(int16_t));
+  Plan->W3i15   = (int16_t *)calloc(N, sizeof(int16_t));
+  Plan->WrF     = (float *)calloc(N, sizeof(float));
+  Plan->WiF     = (float *)calloc(N, sizeof(float));
+  Plan->W3rF    = (float *)calloc(N, sizeof(float));
+  Plan->W3iF    = (float *)calloc(N, sizeof(float));
+  Plan->Rev     = (int32_t *)malloc(N * sizeof(int32_t));
+  if((Plan->Wr31  == NULL) || (Plan->Wi31  == NULL) || (Plan->Wr15 == NULL) ||
+     (Plan->Wi15  == NULL) || (Plan->W3r31 == NULL) || (Plan->W3i31 == NULL) ||
+     (Plan->W3r15 == NULL) || (Plan->W3i15 == NULL) || (Plan->WrF  == NULL) ||
+     (Plan->WiF   == NULL) || (Plan->W3rF  == NULL) || (Plan->W3iF  == NULL) ||
+     (Plan->Rev   == NULL))
+  {
+    DestroyPlan(Plan);
+    return NULL;
+  }
+
+  int in, j, i, b, r;
+
+  // Each twiddle is computed directly from its angle, not by recurrence, so every
+  // entry is correctly rounded.
+  for(in = N >> 1; in > 0; in >>= 1)
+  {
+    int32_t *Wr31 = Plan->Wr31 + FFT_STAGE_OFFSET(N, in);
+    int32_t *Wi31 = Plan->Wi31 + FFT_STAGE_OFFSET(N, in);
+    int16_t *Wr15 = Plan->Wr15 + FFT_STAGE_OFFSET(N, in);
+    int16_t *Wi15 = Plan->Wi15 + FFT_STAGE_OFFSET(N, in);
+
+    for(j = 0; j < in; j++)
+    {
+      double a = M_PI * j / in;
+      double c = cos(a);
+      double s = Ft_Flag * sin(a);
+
+      Wr31[j] = FFT_TwiddleQ31(c);
+      Wi31[j] = FFT_TwiddleQ31(s);
+      Wr15[j] = TwiddleQ15(c);
+      Wi15[j] = TwiddleQ15(s);
+      Plan->WrF[FFT_STAGE_OFFSET(N, in) + j] = (float)c;
+      Plan->WiF[FFT_STAGE_OFFSET(N, in) + j] = (float)s;
+    }
+
+    for(j = 0; j < in / 2; j++)
+    {
+      double a = M_PI * 3 * j / in;
+
+      Plan->W3r31[FFT_STAGE_OFFSET(N, in) + j] = FFT_TwiddleQ31(cos(a));
+      Plan->W3i31[FFT_STAGE_OFFSET(N, in) + j] = FFT_TwiddleQ31(Ft_Flag * sin(a));
+      Plan->W3r15[FFT_STAGE_OFFSET(N, in) + j] = TwiddleQ15(cos(a));
+      Plan->W3i15[FFT_STAGE_OFFSET(N, in) + j] = TwiddleQ15(Ft_Flag * sin(a));
+      Plan->W3rF [FFT_STAGE_OFFSET(N, in) + j] = (float)cos(a);
+      Plan->W3iF [FFT_STAGE_OFFSET(N, in) + j] = (float)(Ft_Flag * sin(a));
+    }
+  }
+  Plan->Wr31[N - 1] = Plan->Wi31[N - 1] = 0;   // Padding, never used.
+  Plan->Wr15[N - 1] = Plan->Wi15[N - 1] = 0;
+
+  for(i = 0; i < N; i++)
+  {
+    for(r = 0, b = 0; b < LogN; b++)
+      r |= ((i >> b) & 1) << (LogN - 1 - b);
+    Plan->Rev[i] = r;
+  }
+
+  return Plan;
+}
+
+
+const FFT_PLAN *FFT_GetPlan(int N, int Ft_Flag)
+{
+  if(!NUMBER_IS_2_POW_K(N))                             return NULL;
+  if((Ft_Flag != FT_DIRECT) && (Ft_Flag != FT_INVERSE)) return NULL;
+
+  int LogN = 0;
+  while((1 << LogN) < N) LogN++;
+  if(LogN > FFT_LOGN_MAX)                               return NULL;
+
+  FFT_PLAN **Slot = &PlanCache[LogN][Ft_Flag == FT_INVERSE];
+  FFT_PLAN  *Plan = __atomic_load_n(Slot, __ATOMIC_ACQUIRE);
+  if(Plan != NULL) return Plan;
+
+  pthread_mutex_lock(&PlanLock);
+  Plan = *Slot;
+  if(Plan == NULL)
+  {
+    Plan = CreatePlan(N, LogN, Ft_Flag);
+    if(Plan != NULL) __atomic_store_n(Slot, Plan, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&PlanLock);
+
+  return Plan;
+}
+
+
+// The passes of FFT_ENGINE<FFT_Q31> (fft_type.h): FFT_Radix4Dif() over FFT_INT_OPS.
+bool FFT_ExecutePlanDif(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+
+  FFT_ENGINE<FFT_Q31, FFT_COUNT_NONE>::Passes(Plan, Rdat, Idat, NULL);
+  return true;
+}
+
+
+bool FFT_ExecutePlanRaw(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat)
+{
+  if(!FFT_ExecutePlanDif(Plan, Rdat, Idat)) return false;
+
+  return FFT_BitReverse(Plan, Rdat, Idat);
+}
+
+
+bool FFT_ExecutePlan(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat)
+{
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+
+  FFT_ENGINE<FFT_Q31, FFT_COUNT_NONE>::Execute(Plan, Rdat, Idat, NULL);
+  return true;
+}
+
+
+void FFT_FreePlans()
+{
+  int LogN, k;
+
+  pthread_mutex_lock(&PlanLock);
+  for(LogN = 0; LogN <= FFT_LOGN_MAX; LogN++)
+    for(k = 0; k < 2; k++)
+    {
+      DestroyPlan(PlanCache[LogN][k]);
+      __atomic_store_n(&PlanCache[LogN][k], (FFT_PLAN *)NULL, __ATOMIC_RELEASE);
+    }
+  pthread_mutex_unlock(&PlanLock);
+}
@@ -0,0 +1,239 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// FFT plans: twiddle and bit-reverse tables built once per (N, Ft_Flag) and shared by
+// all callers through a process-wide cache. A plan is read-only after creation, so any
+// number of threads may execute the same plan at once.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include <stdint.h>
+
+#include "fft_cpp.h"
+
+#define  Q31_ONE          0x7FFFFFFF    // 1.0 in Q31 (saturated).
+#define  Q15_ONE          0x7FFF        // 1.0 in Q15 (saturated).
+
+// Twiddle tables hold one table per stage, stored one after another: the stage with the
+// half-span "in" uses W(j) = exp(Ft_Flag * 2*pi*i * j / (2*in)), j = 0 .. in-1.
+// N/2 + N/4 + ... + 1 = N-1 entries in total.
+#define  FFT_STAGE_OFFSET(N, in)   ((N) - 2*(in))
+
+// The int engine runs radix-4 passes, each one equal to two radix-2 stages (half-spans
+// 2*q and q). It uses W(j) and W(2*j) from the stage tables above and W(3*j) from the
+// W3 tables, which share their layout: entries j = 0 .. q-1 at FFT_STAGE_OFFSET(N, 2*q).
+
+// Complex multiply (xr + i*xi) * (wr + i*wi) by a Q31 twiddle, rounded.
+#define  Q31_CMUL_RE(xr, xi, wr, wi) \
+  ((qint16)(((int64_t)(xr)*(wr) - (int64_t)(xi)*(wi) + (1LL << 30)) >> 31))
+#define  Q31_CMUL_IM(xr, xi, wr, wi) \
+  ((qint16)(((int64_t)(xi)*(wr) + (int64_t)(xr)*(wi) + (1LL << 30)) >> 31))
+
+// Q15 product, rounded half up (the same rounding as x86 PMULHRSW / ARM VQRDMULH).
+#define  Q15_MUL(x, w)   (((int32_t)(x)*(w) + 0x4000) >> 15)
+
+
+//_________________________________________________________________________________________
+//
+// Radix-4 butterflies, shared by every engine. They take their arithmetic from an
+// operations class OPS:
+//
+//    Sample, Twiddle      - stored value, twiddle factor
+//    Add(a, b), Sub(a, b) - a + b, a - b
+//    Rot(Ft, a, b)        - Ft * (a - b), one component of a product by Ft*i
+//    MulRe/MulIm(a, b, wr, wi) - (a + i*b) * (wr + i*wi)
+//
+// FFT_INT_OPS is the arithmetic of FFT(); fft_type.h has those of the other sample types.
+// Each butterfly reads its four points before it writes any, so the references may
+// point into the data or to copies in registers. Twiddles are taken by reference too: a
+// twiddle is then loaded where it is used, not all six ahead of the stores, which runs
+// the int passes out of registers. The butterflies and the operations are always inlined,
+// so that a pass compiles as it would with the arithmetic written out.
+//_________________________________________________________________________________________
+
+#define  FFT_INLINE   inline __attribute__((always_inline))
+
+// qint16 sums and Q31 twiddles.
+struct FFT_INT_OPS
+{
+  typedef qint16   Sample;
+  typedef int32_t  Twiddle;
+
+  FFT_INLINE qint16 Add(qint16 a, qint16 b) const         { return a + b; }
+  FFT_INLINE qint16 Sub(qint16 a, qint16 b) const         { return a - b; }
+  FFT_INLINE qint16 Rot(int Ft, qint16 a, qint16 b) const { return Ft * (a - b); }
+  FFT_INLINE qint16 MulRe(qint16 a, qint16 b, int32_t wr, int32_t wi) const
+  {
+    return Q31_CMUL_RE(a, b, wr, wi);
+  }
+  FFT_INLINE qint16 MulIm(qint16 a, qint16 b, int32_t wr, int32_t wi) const
+  {
+    return Q31_CMUL_IM(a, b, wr, wi);
+  }
+};
+
+// Radix-4 decimation in frequency. A pass over the span ie does the work of the two
+// radix-2 stages with half-spans 2*q and q (q = ie/4) and leaves the data in the same
+// order, so the output is bit-reversed exactly as after radix-2 stages. With u = x0-x2,
+// v = (x1-x3) * W(q) = (x1-x3) * Ft*i and w1, w2, w3 = W(j), W(2j), W(3j):
+//    x0' = (x0+x2) + (x1+x3)
+//    x1' = ((x0+x2) - (x1+x3)) * w2
+//    x2' = (u + v) * w1
+//    x3' = (u - v) * w3
+// That is 3 complex multiplies per 4 points instead of 4, and half the passes.
+template<class OPS>
+static FFT_INLINE
+void FFT_Radix4Dif(const OPS &Op, int Ft,
+                   typename OPS::Sample &x0r, typename OPS::Sample &x0i,
+                   typename OPS::Sample &x1r, typename OPS::Sample &x1i,
+                   typename OPS::Sample &x2r, typename OPS::Sample &x2i,
+                   typename OPS::Sample &x3r, typename OPS::Sample &x3i,
+                   const typename OPS::Twiddle &w1r, const typename OPS::Twiddle &w1i,
+                   const typename OPS::Twiddle &w2r, const typename OPS::Twiddle &w2i,
+                   const typename OPS::Twiddle &w3r, const typename OPS::Twiddle &w3i)
+{
+  typename OPS::Sample rtp, itp, rtq, itq, rtu, itu, rtv, itv, r, i;
+
+  rtp = Op.Add(x0r, x2r);
+  itp = Op.Add(x0i, x2i);
+  rtq = Op.Add(x1r, x3r);
+  itq = Op.Add(x1i, x3i);
+  rtu = Op.Sub(x0r, x2r);
+  itu = Op.Sub(x0i, x2i);
+  rtv = Op.Rot(Ft, x3i, x1i);
+  itv = Op.Rot(Ft, x1r, x3r);
+
+  x0r = Op.Add(rtp, rtq);
+  x0i = Op.Add(itp, itq);
+
+  r   = Op.Sub(rtp, rtq);
+  i   = Op.Sub(itp, itq);
+  x1r = Op.MulRe(r, i, w2r, w2i);
+  x1i = Op.MulIm(r, i, w2r, w2i);
+
+  r   = Op.Add(rtu, rtv);
+  i   = Op.Add(itu, itv);
+  x2r = Op.MulRe(r, i, w1r, w1i);
+  x2i = Op.MulIm(r, i, w1r, w1i);
+
+  r   = Op.Sub(rtu, rtv);
+  i   = Op.Sub(itu, itv);
+  x3r = Op.MulRe(r, i, w3r, w3i);
+  x3i = Op.MulIm(r, i, w3r, w3i);
+}
+
+// The transpose of FFT_Radix4Dif() (decimation in time), for passes run in the reverse
+// order. With b1 = x1 * w2, b2 = x2 * w1, b3 = x3 * w3:
+//    x0' = (x0 + b1) + (b2 + b3)         x2' = (x0 + b1) - (b2 + b3)
+//    x1' = (x0 - b1) + Ft*i*(b2 - b3)    x3' = (x0 - b1) - Ft*i*(b2 - b3)
+template<class OPS>
+static FFT_INLINE
+void FFT_Radix4Dit(const OPS &Op, int Ft,
+                   typename OPS::Sample &x0r, typename OPS::Sample &x0i,
+                   typename OPS::Sample &x1r, typename OPS::Sample &x1i,
+                   typename OPS::Sample &x2r, typename OPS::Sample &x2i,
+                   typename OPS::Sample &x3r, typename OPS::Sample &x3i,
+                   const typename OPS::Twiddle &w1r, const typename OPS::Twiddle &w1i,
+                   const typename OPS::Twiddle &w2r, const typename OPS::Twiddle &w2i,
+                   const typename OPS::Twiddle &w3r, const typename OPS::Twiddle &w3i)
+{
+  typename OPS::Sample br1, bi1, br2, bi2, br3, bi3, rts, its, rtd, itd, rtu, itu, rtv, itv;
+
+  br1 = Op.MulRe(x1r, x1i, w2r, w2i);
+  bi1 = Op.MulIm(x1r, x1i, w2r, w2i);
+  br2 = Op.MulRe(x2r, x2i, w1r, w1i);
+  bi2 = Op.MulIm(x2r, x2i, w1r, w1i);
+  br3 = Op.MulRe(x3r, x3i, w3r, w3i);
+  bi3 = Op.MulIm(x3r, x3i, w3r, w3i);
+
+  rts = Op.Add(x0r, br1);
+  its = Op.Add(x0i, bi1);
+  rtd = Op.Sub(x0r, br1);
+  itd = Op.Sub(x0i, bi1);
+  rtu = Op.Add(br2, br3);
+  itu = Op.Add(bi2, bi3);
+  rtv = Op.Rot(Ft, bi3, bi2);
+  itv = Op.Rot(Ft, br2, br3);
+
+  x0r = Op.Add(rts, rtu);
+  x0i = Op.Add(its, itu);
+  x2r = Op.Sub(rts, rtu);
+  x2i = Op.Sub(its, itu);
+  x1r = Op.Add(rtd, rtv);
+  x1i = Op.Add(itd, itv);
+  x3r = Op.Sub(rtd, rtv);
+  x3i = Op.Sub(itd, itv);
+}
+
+typedef struct FFT_PLAN
+{
+  int       N;          // Number of points.
+  int       LogN;       // Logarithm2(N).
+  int       Ft_Flag;    // FT_DIRECT or FT_INVERSE.
+  int32_t  *Wr31;       // Q31 twiddles, real part      (N-1 entries, see FFT_STAGE_OFFSET).
+  int32_t  *Wi31;       // Q31 twiddles, imaginary part (N-1 entries).
+  int16_t  *Wr15;       // Q15 twiddles, real part      (N-1 entries).
+  int16_t  *Wi15;       // Q15 twiddles, imaginary part (N-1 entries).
+  int32_t  *W3r31;      // Q31 W(3*j) of the radix-4 passes, real part.
+  int32_t  *W3i31;      // Q31 W(3*j) of the radix-4 passes, imaginary part.
+  int16_t  *W3r15;      // Q15 W(3*j), real part.
+  int16_t  *W3i15;      // Q15 W(3*j), imaginary part.
+  float    *WrF;        // float twiddles, the layout of Wr31 (see fft_type.h).
+  float    *WiF;
+  float    *W3rF;       // float W(3*j).
+  float    *W3iF;
+  int32_t  *Rev;        // Bit-reverse permutation: Rev[i] = bitreverse(i) over LogN bits.
+} FFT_PLAN;
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_GetPlan.
+// PURPOSE:       Returns the cached plan for (N, Ft_Flag), building it on first use.
+//                Lookups of an existing plan take no lock.
+//
+// PARAMETERS:
+//
+//    int    N       [in]      - Number of points: 2, 4, 8, ... 2**FFT_LOGN_MAX
+//    int    Ft_Flag [in]      - FT_DIRECT or FT_INVERSE
+//
+// RETURN VALUE:  plan pointer, NULL on parameter error or out of memory.
+//_________________________________________________________________________________________
+
+const FFT_PLAN *FFT_GetPlan(int N, int Ft_Flag);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlan.
+// PURPOSE:       In-place transform of Rdat/Idat (Plan->N samples) with the same
+//                scaling and output order as FFT(): the direct transform is divided
+//                by N, the inverse one is not scaled; output is in natural order.
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlan(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat);
+
+// Same as FFT_ExecutePlan() without the division by N of the direct transform, for
+// callers that fold the scaling into their own passes.
+bool FFT_ExecutePlanRaw(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat);
+
+// The butterfly passes alone: no scaling and no reorder, the output is bit-reversed.
+bool FFT_ExecutePlanDif(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat);
+
+// Rounds x (-1 <= x <= 1) to Q31, saturated: the conversion used for every Q31 table.
+int32_t FFT_TwiddleQ31(double x);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_FreePlans.
+// PURPOSE:       Releases every cached plan. Must not run concurrently with any
+//                transform; pointers returned by FFT_GetPlan() become invalid.
+//_________________________________________________________________________________________
+
+void FFT_FreePlans();
+
+#endif
@@ -0,0 +1,274 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Work-stealing thread pool (see fft_pool.h).
+//
+// Each deque is the index range [Head, Tail) under its own lock. The bounds are also
+// stored atomically, so thieves can compare sizes without locking. The owner pops at
+// Tail and thieves cut at Head, so owner and thief rarely wait on each other. Stolen
+// tasks are invisible while they move to the thief's range. Another worker may then
+// leave early, but only the thief can run those tasks, so nothing is lost.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "fft_pool.h"
+
+
+typedef struct
+{
+  pthread_mutex_t  Lock;
+  int              Head;
+  int              Tail;
+} POOL_DEQUE;
+
+struct POOL
+{
+  int              Workers;
+  pthread_t       *Threads;       // Workers - 1 threads; the caller is worker 0.
+  POOL_DEQUE      *Deques;
+
+  pthread_mutex_t  RunLock;       // Serialises POOL_Run().
+  pthread_mutex_t  Lock;          // Guards the fields below.
+  pthread_cond_t   Start;
+  pthread_cond_t   Done;
+  unsigned         Generation;    // Incremented for every job.
+  int              Busy;          // Threads still working on the current job.
+  bool             Quit;
+
+  POOL_TASK        Task;
+  void            *Arg;
+};
+
+typedef struct
+{
+  POOL  *Pool;
+  int    Worker;
+} POOL_START;
+
+
+static bool PopOwn(POOL_DEQUE *D, int *Index)
+{
+  bool Got = false;
+
+  pthread_mutex_lock(&D->Lock);
+  if(D->Head < D->Tail)
+  {
+    *Index = D->Tail - 1;
+    Got    = true;
+    __atomic_store_n(&D->Tail, *Index, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&D->Lock);
+  return Got;
+}
+
+// Moves the front half (at least one task) of the fullest other deque into deque w.
+static bool Steal(POOL *Pool, int w)
+{
+  int v, Victim = -1, Most = 0, Head = 0, Tail = 0;
+
+  for(v = 0; v < Pool->Workers; v++)
+  {
+    POOL_DEQUE *D = &Pool->Deques[v];
+    int         Left;
+
+    if(v == w) continue;
+    Left = __atomic_load_n(&D->Tail, __ATOMIC_RELAXED) - __atomic_load_n(&D->Head, __ATOMIC_RELAXED);
+    if(Left > Most)
+    {
+      Most   = Left;
+      Victim = v;
+    }
+  }
+  if(Victim < 0) return false;
+
+  POOL_DEQUE *D = &Pool->Deques[Victim];
+
+  pthread_mutex_lock(&D->Lock);
+  if(D->Head < D->Tail)
+  {
+    Head     = D->Head;
+    Tail     = Head + (D->Tail - D->Head + 1) / 2;
+    __atomic_store_n(&D->Head, Tail, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&D->Lock);
+  if(Head == Tail) return true;     // Lost the race; the caller scans again.
+
+  D = &Pool->Deques[w];
+  pthread_mutex_lock(&D->Lock);
+  __atomic_store_n(&D->Head, Head, __ATOMIC_RELAXED);
+  __atomic_store_n(&D->Tail, Tail, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&D->Lock);
+  return true;
+}
+
+static void WorkLoop(POOL *Pool, int w)
+{
+  int Index;
+
+  for(;;)
+  {
+    while(PopOwn(&Pool->Deques[w], &Index))
+      Pool->Task(Pool->Arg, Index, w);
+
+    if(!Steal(Pool, w)) return;
+  }
+}
+
+static void *WorkerThread(void *Param)
+{
+  POOL_START *S    = (POOL_START *)Param;
+  POOL       *Pool = S->Pool;
+  int         w    = S->Worker;
+  unsigned    Seen = 0;
+
+  free(S);
+
+  for(;;)
+  {
+    pthread_mutex_lock(&Pool->Lock);
+    while(!Pool->Quit && (Pool->Generation == Seen))
+      pthread_cond_wait(&Pool->Start, &Pool->Lock);
+    if(Pool->Quit)
+    {
+      pthread_mutex_unlock(&Pool->Lock);
+      return NULL;
+    }
+    Seen = Pool->Generation;
+    pthread_mutex_unlock(&Pool->Lock);
+
+    WorkLoop(Pool, w);
+
+    pthread_mutex_lock(&Pool->Lock);
+    if(--Pool->Busy == 0) pthread_cond_signal(&Pool->Done);
+    pthread_mutex_unlock(&Pool->Lock);
+  }
+}
+
+
+POOL *POOL_Create(int Workers)
+{
+  if(Workers < 0) return NULL;
+  if(Workers == 0)
+  {
+    long Cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    Workers   = (Cpus > 0) ? (int)Cpus : 1;
+  }
+
+  POOL *Pool = (POOL *)calloc(1, sizeof(POOL));
+  if(Pool == NULL) return NULL;
+
+  Pool->Workers = Workers;
+  Pool->Deques  = (POOL_DEQUE *)calloc(Workers, sizeof(POOL_DEQUE));
+  Pool->Threads = (pthread_t *)calloc(Workers, sizeof(pthread_t));
+  if((Pool->Deques == NULL) || (Pool->Threads == NULL))
+  {
+    free(Pool->Deques);
+    free(Pool->Threads);
+    free(Pool);
+    return NULL;
+  }
+
+  int w;
+
+  for(w = 0; w < Workers; w++)
+    pthread_mutex_init(&Pool->Deques[w].Lock, NULL);
+  pthread_mutex_init(&Pool->RunLock, NULL);
+  pthread_mutex_init(&Pool->Lock, NULL);
+  pthread_cond_init(&Pool->Start, NULL);
+  pthread_cond_init(&Pool->Done, NULL);
+
+  for(w = 1; w < Workers; w++)
+  {
+    POOL_START *S = (POOL_START *)malloc(sizeof(POOL_START));
+
+    if(S != NULL)
+    {
+      S->Pool   = Pool;
+      S->Worker = w;
+      if(pthread_create(&Pool->Threads[w], NULL, WorkerThread, S) == 0) continue;
+      free(S);
+    }
+
+    // Keep the threads that did start.
+    Pool->Workers = w;
+    break;
+  }
+
+  return Pool;
+}
+
+
+bool POOL_Run(POOL *Pool, int Count, POOL_TASK Task, void *Arg)
+{
+  if((Pool == NULL) || (Task == NULL) || (Count < 0)) return false;
+  if(Count == 0)                                      return true;
+
+  const int W = Pool->Workers;
+  int       w;
+
+  pthread_mutex_lock(&Pool->RunLock);
+
+  for(w = 0; w < W; w++)
+  {
+    pthread_mutex_lock(&Pool->Deques[w].Lock);
+    __atomic_store_n(&Pool->Deques[w].Head, (int)((int64_t)Count * w / W),       __ATOMIC_RELAXED);
+    __atomic_store_n(&Pool->Deques[w].Tail, (int)((int64_t)Count * (w + 1) / W), __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&Pool->Deques[w].Lock);
+  }
+
+  pthread_mutex_lock(&Pool->Lock);
+  Pool->Task = Task;
+  Pool->Arg  = Arg;
+  Pool->Busy = W - 1;
+  Pool->Generation++;
+  pthread_cond_broadcast(&Pool->Start);
+  pthread_mutex_unlock(&Pool->Lock);
+
+  WorkLoop(Pool, 0);
+
+  pthread_mutex_lock(&Pool->Lock);
+  while(Pool->Busy > 0)
+    pthread_cond_wait(&Pool->Done, &Pool->Lock);
+  pthread_mutex_unlock(&Pool->Lock);
+
+  pthread_mutex_unlock(&Pool->RunLock);
+  return true;
+}
+
+
+int POOL_Workers(const POOL *Pool)
+{
+  return (Pool == NULL) ? 0 : Pool->Workers;
+}
+
+
+void POOL_Destroy(POOL *Pool)
+{
+  if(Pool == NULL) return;
+
+  int w;
+
+  pthread_mutex_lock(&Pool->Lock);
+  Pool->Quit = true;
+  pthread_cond_broadcast(&Pool->Start);
+  pthread_mutex_unlock(&Pool->Lock);
+
+  for(w = 1; w < Pool->Workers; w++)
+    pthread_join(Pool->Threads[w], NULL);
+
+  for(w = 0; w < Pool->Workers; w++)
+    pthread_mutex_destroy(&Pool->Deques[w].Lock);
+  pthread_mutex_destroy(&Pool->RunLock);
+  pthread_mutex_destroy(&Pool->Lock);
+  pthread_cond_destroy(&Pool->Start);
+  pthread_cond_destroy(&Pool->Done);
+
+  free(Pool->Threads);
+  free(Pool->Deques);
+  free(Pool);
+}
@@ -0,0 +1,64 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Work-stealing thread pool for independent, index-addressed tasks.
+//
+// POOL_Run() splits the task indices 0 .. Count-1 into one contiguous range per worker.
+// A worker takes tasks from the back of its own range. When that runs dry it steals the
+// front half of the fullest other range. Uneven tasks therefore balance without a
+// shared queue. The calling thread works as worker 0, and POOL_Run() returns when every
+// task has finished.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_POOL_H
+#define FFT_POOL_H
+
+#include <stdint.h>
+
+typedef struct POOL POOL;
+
+// Task body: Index is the task number, Worker (0 .. POOL_Workers()-1) the thread running
+// it, e.g. to pick per-thread scratch memory.
+typedef void (*POOL_TASK)(void *Arg, int Index, int Worker);
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          POOL_Create.
+// PURPOSE:       Start a pool.
+//
+// PARAMETERS:
+//
+//    int    Workers [in]      - Number of workers including the caller; 0 - one per
+//                               online CPU
+//
+// RETURN VALUE:  the pool, or NULL when threads or memory are not available.
+//_________________________________________________________________________________________
+
+POOL *POOL_Create(int Workers);
+
+//_________________________________________________________________________________________
+//
+// NAME:          POOL_Run.
+// PURPOSE:       Run Task(Arg, i, Worker) for i = 0 .. Count-1 and wait for all of them.
+//                Calls from different threads are serialised.
+//
+// PARAMETERS:
+//
+//    POOL      *Pool  [in]    - Pool from POOL_Create()
+//    int        Count [in]    - Number of tasks, Count >= 0
+//    POOL_TASK  Task  [in]    - Task body
+//    void      *Arg   [in]    - Passed to every task
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool POOL_Run(POOL *Pool, int Count, POOL_TASK Task, void *Arg);
+
+int  POOL_Workers(const POOL *Pool);
+
+// Stops and joins the threads. NULL is ignored.
+void POOL_Destroy(POOL *Pool);
+
+#endif
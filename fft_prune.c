@@ -0,0 +1,229 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Pruned FFT (see fft_prune.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fft_prune.h"
+#include "fft_order.h"
+
+
+// True when a bin of the window [Bin0, Bin0 + BinCount) is congruent to r mod P
+// (P divides N, so the window may be taken without wrapping).
+static bool Wanted(int r, int P, int Bin0, int BinCount)
+{
+  if(BinCount >= P) return true;
+
+  return ((r - Bin0) & (P - 1)) < BinCount;
+}
+
+// bitreverse(x) over b bits.
+static int RevBits(const FFT_PLAN *Plan, int x, int b)
+{
+  return (b == 0) ? 0 : Plan->Rev[x] >> (Plan->LogN - b);
+}
+
+
+bool FFT_ExecutePlanPruned(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat,
+                           int InCount, int Bin0, int BinCount)
+{
+  // parameters error check:
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+  if((InCount < 1) || (InCount > Plan->N))               return false;
+  if((Bin0 < 0) || (Bin0 >= Plan->N))                    return false;
+  if((BinCount < 1) || (BinCount > Plan->N))             return false;
+
+  const int          N    = Plan->N;
+  const int          Ft   = Plan->Ft_Flag;
+  const FFT_INT_OPS  Op;
+  int                c    = InCount;        // Points of a group that may be non-zero.
+  int                i, j, k, g, q, ie, b, Jend;
+  qint16             rtp, itp;
+
+  memset(Rdat + InCount, 0, (N - InCount) * sizeof(qint16));
+  memset(Idat + InCount, 0, (N - InCount) * sizeof(qint16));
+
+  // The radix-4 passes of FFT_ExecutePlanDif(); b = log2(N/ie) bits of k are fixed.
+  for(ie = N, b = 0; ie >= 4; ie >>= 2, b += 2)
+  {
+    q    = ie >> 2;
+    Jend = (c < q) ? c : q;
+
+    const int32_t *W1r = Plan->Wr31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W1i = Plan->Wi31  + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W2r = Plan->Wr31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W2i = Plan->Wi31  + FFT_STAGE_OFFSET(N, q);
+    const int32_t *W3r = Plan->W3r31 + FFT_STAGE_OFFSET(N, 2*q);
+    const int32_t *W3i = Plan->W3i31 + FFT_STAGE_OFFSET(N, 2*q);
+
+    for(g = 0; g < N; g += ie)
+    {
+      if(!Wanted(RevBits(Plan, g / ie, b), N / ie, Bin0, BinCount)) continue;
+
+      qint16 *R0 = Rdat + g, *R1 = R0 + q, *R2 = R1 + q, *R3 = R2 + q;
+      qint16 *I0 = Idat + g, *I1 = I0 + q, *I2 = I1 + q, *I3 = I2 + q;
+
+      for(j = 0; j < Jend; j++)
+        FFT_Radix4Dif(Op, Ft, R0[j], I0[j], R1[j], I1[j], R2[j], I2[j], R3[j], I3[j],
+                      W1r[j], W1i[j], W2r[j], W2i[j], W3r[j], W3i[j]);
+    }
+
+    c = Jend;
+  }
+
+  // Odd LogN: the radix-2 stage with the half-span 1.
+  if(ie == 2)
+  {
+    for(i = 0; i < N; i += 2)
+    {
+      if(!Wanted(RevBits(Plan, i / 2, b), N / 2, Bin0, BinCount)) continue;
+
+      rtp       = Rdat[i] + Rdat[i + 1];
+      itp       = Idat[i] + Idat[i + 1];
+      Rdat[i+1] = Rdat[i] - Rdat[i + 1];
+      Idat[i+1] = Idat[i] - Idat[i + 1];
+      Rdat[i]   = rtp;
+      Idat[i]   = itp;
+    }
+  }
+
+  // Bin k is at Rev[k]. All N bins take the ordinary (blocked, for large N) permutation.
+  // Otherwise writes go only to wanted bins, and a wanted bin holds the source of another
+  // wanted bin only when the two are a swap pair, so every source is read intact.
+  if(BinCount == N)
+  {
+    FFT_BitReverse(Plan, Rdat, Idat);
+    Bin0 = 0;
+  }
+  else
+  {
+    for(j = 0; j < BinCount; j++)
+    {
+      k = (Bin0 + j) & (N - 1);
+      i = Plan->Rev[k];
+
+      if(((i - Bin0) & (N - 1)) < BinCount)
+      {
+        if(k < i)
+        {
+          rtp     = Rdat[i];
+          itp     = Idat[i];
+          Rdat[i] = Rdat[k];
+          Idat[i] = Idat[k];
+          Rdat[k] = rtp;
+          Idat[k] = itp;
+        }
+      }
+      else
+      {
+        Rdat[k] = Rdat[i];
+        Idat[k] = Idat[i];
+      }
+    }
+  }
+
+  if(Ft == FT_DIRECT)
+    for(j = 0; j < BinCount; j++)
+    {
+      k        = (Bin0 + j) & (N - 1);
+      Rdat[k] /= N;
+      Idat[k] /= N;
+    }
+
+  return true;
+}
+
+
+bool FFT_PRUNE_probe()
+{
+  const int  Nmax = 1 << FFT_LOGN_MAX;
+  qint16    *Rref = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Iref = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Rgot = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Igot = (qint16 *)malloc(Nmax * sizeof(qint16));
+  uint32_t   Seed = 1;
+  int        LogN, d, t, n, j, k;
+  bool       Ok = true;
+
+  if((Rref == NULL) || (Iref == NULL) || (Rgot == NULL) || (Igot == NULL))
+  {
+    printf("PRUNE: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+    for(d = 0; (d < 2) && Ok; d++)
+      for(t = 0; (t < 8) && Ok; t++)
+      {
+        const int       N    = 1 << LogN;
+        const int       Dir  = d ? FT_INVERSE : FT_DIRECT;
+        const FFT_PLAN *Plan = FFT_GetPlan(N, Dir);
+        int             InCount, Bin0, BinCount;
+
+        // Trial 0: short input and a window that wraps past N; trial 1: every bin;
+        // the rest: anything.
+        Seed     = Seed * 1664525u + 1013904223u;
+        InCount  = 1 + (int)((Seed >> 8) % N);
+        Seed     = Seed * 1664525u + 1013904223u;
+        Bin0     = (int)((Seed >> 8) % N);
+        Seed     = Seed * 1664525u + 1013904223u;
+        BinCount = 1 + (int)((Seed >> 8) % N);
+        if(t == 0)
+        {
+          InCount  = 1 + InCount / 2;
+          Bin0     = N - 1 - Bin0 / 4;
+          BinCount = N - Bin0 + 1 + (BinCount - 1) / 4;
+        }
+        else if(t == 1)
+          BinCount = N;
+
+        // The padding of the pruned input holds garbage, which it must ignore.
+        for(n = 0; n < N; n++)
+        {
+          Seed = Seed * 1664525u + 1013904223u;
+          Rgot[n] = (int16_t)(Seed >> 16);
+          Seed = Seed * 1664525u + 1013904223u;
+          Igot[n] = (int16_t)(Seed >> 16);
+          Rref[n] = (n < InCount) ? Rgot[n] : 0;
+          Iref[n] = (n < InCount) ? Igot[n] : 0;
+        }
+
+        if((Plan == NULL) || !FFT_ExecutePlan(Plan, Rref, Iref) ||
+           !FFT_ExecutePlanPruned(Plan, Rgot, Igot, InCount, Bin0, BinCount))
+        {
+          printf("PRUNE: transform failed at N=%d\n", N);
+          Ok = false;
+          break;
+        }
+
+        for(j = 0; j < BinCount; j++)
+        {
+          k = (Bin0 + j) & (N - 1);
+          if((Rgot[k] != Rref[k]) || (Igot[k] != Iref[k]))
+          {
+            printf("PRUNE: bin %d differs from FFT_ExecutePlan() at N=%d, %s, "
+                   "InCount %d, Bin0 %d, BinCount %d\n", k, N, d ? "inverse" : "direct",
+                   InCount, Bin0, BinCount);
+            Ok = false;
+            break;
+          }
+        }
+      }
+
+  if(Ok)
+    printf("PRUNE: bins bit-identical to FFT_ExecutePlan(), N=4..%d, both directions\n", Nmax);
+
+done:
+  free(Rref);
+  free(Iref);
+  free(Rgot);
+  free(Igot);
+  return Ok;
+}
@@ -0,0 +1,60 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Pruned FFT: zero-padded input and/or a window of output bins.
+//
+// Input pruning: only the first InCount samples may be non-zero. The padding is still
+// read: by the butterflies that are kept (their points x1..x3 lie in it), by the radix-2
+// stage of odd LogN and by the permutation. So FFT_ExecutePlanPruned() first writes
+// zeros into all N - InCount padding points, and the caller need not clear them. A
+// radix-4 pass over the span ie whose groups hold data only in their first c points
+// (c <= ie/4) skips every butterfly j >= c, since all four of its inputs are zero. The
+// data then stays in the first min(c, ie/4) points of each sub-group. A signal padded to
+// 4**p times its length saves the butterflies of the first p passes in proportion.
+//
+// Output pruning: after the DIF passes down to the span ie, the group starting at g holds
+// the bins k with k mod (N/ie) = bitreverse(g/ie), taking the low log2(N/ie) bits. A group
+// no wanted bin falls into is skipped, so a pass touches min(N, W*ie) points for a window
+// of W bins. The first log4(W) passes run in full, and all later ones cost about N
+// together instead of N each. Only the wanted bins are moved to their natural place and
+// scaled; the permutation touches W points, not N.
+//
+// The bins that are computed are bit-identical to FFT_ExecutePlan(). Every other point
+// of the arrays is left undefined.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_PRUNE_H
+#define FFT_PRUNE_H
+
+#include "fft_plan.h"
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanPruned.
+// PURPOSE:       In-place transform of the first InCount samples (the rest overwritten by
+//                zeros) for the output bins Bin0, Bin0 + 1, ... Bin0 + BinCount - 1
+//                (mod N, so a window around bin 0 may wrap). Scaling as FFT_ExecutePlan().
+//
+// PARAMETERS:
+//
+//    FFT_PLAN *Plan     [in]      - Plan from FFT_GetPlan()
+//    qint16   *Rdat     [in, out] - Real part of Input and Output Data, N samples
+//    qint16   *Idat     [in, out] - Imaginary part of Input and Output Data, N samples
+//    int      InCount   [in]      - Number of leading samples that may be non-zero: 1 .. N
+//    int      Bin0      [in]      - First wanted bin: 0 .. N-1
+//    int      BinCount  [in]      - Number of wanted bins: 1 .. N
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanPruned(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat,
+                           int InCount, int Bin0, int BinCount);
+
+// Checks the wanted bins against FFT_ExecutePlan() of the zero-padded input, bit for
+// bit, for random (InCount, Bin0, BinCount) at every N and both directions, including
+// windows that wrap past N and BinCount = N. Prints one line; false on any difference.
+bool FFT_PRUNE_probe();
+
+#endif
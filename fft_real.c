@@ -0,0 +1,227 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Real-signal FFT (see fft_real.h).
+//
+// With Z = FFT(N/2)(z), M = N/2 and W = exp(-2*pi*i/N):
+//    X[k] = ( (Z[k] + conj(Z[M-k])) - i * W**k * (Z[k] - conj(Z[M-k])) ) / 2
+// and backwards, with V = 1/W:
+//    Z[k] = (X[k] + conj(X[M-k])) + i * V**k * (X[k] - conj(X[M-k]))
+// Bins k and M-k are computed together, in place. W**k is taken from the first stage
+// table of the N-point plan.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "fft_real.h"
+#include "fft_plan.h"
+
+
+bool FFT_Real(const qint16 *Sig, qint16 *Rdat, qint16 *Idat, int N, int LogN)
+{
+  // parameters error check:
+  if((Sig == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
+
+  const FFT_PLAN *Half = FFT_GetPlan(N >> 1, FT_DIRECT);
+  const FFT_PLAN *Full = FFT_GetPlan(N,      FT_DIRECT);
+  if((Half == NULL) || (Full == NULL))                  return false;
+
+  const int      M  = N >> 1;
+  const int32_t *Wr = Full->Wr31 + FFT_STAGE_OFFSET(N, M);
+  const int32_t *Wi = Full->Wi31 + FFT_STAGE_OFFSET(N, M);
+  int            k, kk;
+  qint16         ar, ai, br, bi, er, ei, dr, di, tr, ti;
+
+  for(k = 0; k < M; k++)
+  {
+    Rdat[k] = Sig[2*k];
+    Idat[k] = Sig[2*k + 1];
+  }
+
+  FFT_ExecutePlanRaw(Half, Rdat, Idat);
+
+  // Bins 0 and N/2 are real: the sum and the difference of the even and odd parts.
+  ar      = Rdat[0];
+  ai      = Idat[0];
+  Rdat[0] = (qint16)(((int64_t)ar + ai) / N);
+  Idat[0] = 0;
+  Rdat[M] = (qint16)(((int64_t)ar - ai) / N);
+  Idat[M] = 0;
+
+  for(k = 1; k <= M / 2; k++)
+  {
+    kk = M - k;
+    ar = Rdat[k];
+    ai = Idat[k];
+    br = Rdat[kk];
+    bi = Idat[kk];
+    er = ar + br;                   // Z[k] + conj(Z[M-k])
+    ei = ai - bi;
+    dr = ar - br;                   // Z[k] - conj(Z[M-k])
+    di = ai + bi;
+
+    // -i * D * W**k, then the pair's mirror: -i * (-conj(D)) * W**(M-k).
+    tr       = Q31_CMUL_RE(di, -dr, Wr[k], Wi[k]);
+    ti       = Q31_CMUL_IM(di, -dr, Wr[k], Wi[k]);
+    Rdat[k]  = (qint16)(((int64_t)er + tr) / (2*N));
+    Idat[k]  = (qint16)(((int64_t)ei + ti) / (2*N));
+
+    tr       = Q31_CMUL_RE(di,  dr, Wr[kk], Wi[kk]);
+    ti       = Q31_CMUL_IM(di,  dr, Wr[kk], Wi[kk]);
+    Rdat[kk] = (qint16)(((int64_t)er + tr) / (2*N));
+    Idat[kk] = (qint16)(((int64_t)ti - ei) / (2*N));
+  }
+
+  return true;
+}
+
+
+bool FFT_RealInverse(qint16 *Rdat, qint16 *Idat, qint16 *Sig, int N, int LogN)
+{
+  // parameters error check:
+  if((Sig == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+  if(!NUMBER_IS_2_POW_K(N))                             return false;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return false;
+  if(N != (1 << LogN))                                  return false;
+
+  const FFT_PLAN *Half = FFT_GetPlan(N >> 1, FT_INVERSE);
+  const FFT_PLAN *Full = FFT_GetPlan(N,      FT_INVERSE);
+  if((Half == NULL) || (Full == NULL))                  return false;
+
+  const int      M  = N >> 1;
+  const int32_t *Vr = Full->Wr31 + FFT_STAGE_OFFSET(N, M);
+  const int32_t *Vi = Full->Wi31 + FFT_STAGE_OFFSET(N, M);
+  int            k, kk;
+  qint16         ar, ai, br, bi, er, ei, dr, di, pr, pi;
+
+  ar      = Rdat[0];
+  ai      = Idat[0];
+  br      = Rdat[M];
+  bi      = Idat[M];
+  Rdat[0] = (ar + br) - (ai + bi);
+  Idat[0] = (ai - bi) + (ar - br);
+
+  for(k = 1; k <= M / 2; k++)
+  {
+    kk = M - k;
+    ar = Rdat[k];
+    ai = Idat[k];
+    br = Rdat[kk];
+    bi = Idat[kk];
+    er = ar + br;                   // X[k] + conj(X[M-k])
+    ei = ai - bi;
+    dr = ar - br;                   // X[k] - conj(X[M-k])
+    di = ai + bi;
+
+    // i * D * V**k, then the pair's mirror: i * (-conj(D)) * V**(M-k).
+    pr       = Q31_CMUL_RE(dr, di, Vr[k], Vi[k]);
+    pi       = Q31_CMUL_IM(dr, di, Vr[k], Vi[k]);
+    Rdat[k]  = er - pi;
+    Idat[k]  = ei + pr;
+
+    pr       = Q31_CMUL_RE(-dr, di, Vr[kk], Vi[kk]);
+    pi       = Q31_CMUL_IM(-dr, di, Vr[kk], Vi[kk]);
+    Rdat[kk] = er - pi;
+    Idat[kk] = pr - ei;
+  }
+
+  FFT_ExecutePlanRaw(Half, Rdat, Idat);
+
+  for(k = 0; k < M; k++)
+  {
+    Sig[2*k]     = Rdat[k];
+    Sig[2*k + 1] = Idat[k];
+  }
+
+  return true;
+}
+
+
+bool FFT_REAL_probe()
+{
+  const int  Nmax = 1 << FFT_LOGN_MAX;
+  qint16    *Sig  = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Back = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Rexp = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Iexp = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Rdat = (qint16 *)malloc((Nmax / 2 + 1) * sizeof(qint16));
+  qint16    *Idat = (qint16 *)malloc((Nmax / 2 + 1) * sizeof(qint16));
+  uint32_t   Seed = 1;
+  int        LogN, n, k, Err;
+  bool       Ok = true;
+
+  if((Sig == NULL) || (Back == NULL) || (Rexp == NULL) || (Iexp == NULL) ||
+     (Rdat == NULL) || (Idat == NULL))
+  {
+    printf("REAL: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+  {
+    const int N = 1 << LogN;
+
+    // The split pass rounds where the complex transform does not: bins within 1 LSB.
+    // The direct transform truncates every bin after the division by N, and the inverse
+    // one adds up N such errors of either sign: a few sqrt(N) LSB.
+    const int Bound = (int)(6.0 * sqrt((double)N));
+
+    for(n = 0; n < N; n++)
+    {
+      Seed = Seed * 1664525u + 1013904223u;
+      Sig[n]  = Rexp[n] = (int16_t)(Seed >> 16);
+      Iexp[n] = 0;
+    }
+
+    if(!FFT(Rexp, Iexp, N, LogN, FT_DIRECT) || !FFT_Real(Sig, Rdat, Idat, N, LogN))
+    {
+      printf("REAL: transform failed at N=%d\n", N);
+      Ok = false;
+      break;
+    }
+
+    for(k = 0; k <= N / 2; k++)
+      if((abs(Rdat[k] - Rexp[k]) > 1) || (abs(Idat[k] - Iexp[k]) > 1))
+      {
+        printf("REAL: bin %d differs from FFT() by more than 1 LSB at N=%d\n", k, N);
+        Ok = false;
+        break;
+      }
+
+    if(Ok && !FFT_RealInverse(Rdat, Idat, Back, N, LogN))
+    {
+      printf("REAL: inverse failed at N=%d\n", N);
+      Ok = false;
+    }
+
+    for(n = 0; (n < N) && Ok; n++)
+    {
+      Err = abs(Back[n] - Sig[n]);
+      if(Err > Bound)
+      {
+        printf("REAL: round trip off by %d LSB at N=%d (bound %d)\n", Err, N, Bound);
+        Ok = false;
+      }
+    }
+  }
+
+  if(Ok)
+    printf("REAL: bins within 1 LSB of FFT(), round trip within 6*sqrt(N) LSB, N=4..%d\n", Nmax);
+
+done:
+  free(Sig);
+  free(Back);
+  free(Rexp);
+  free(Iexp);
+  free(Rdat);
+  free(Idat);
+  return Ok;
+}
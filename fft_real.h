@@ -0,0 +1,60 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Real-signal FFT. N real samples are packed as N/2 complex ones, z[m] = x[2m] + i*x[2m+1],
+// transformed with an N/2-point complex FFT and split into the N/2+1 non-redundant bins
+// by one post-processing pass (X[N-k] = conj(X[k]) gives the rest). The inverse runs
+// the same steps backwards. Half the butterflies and half the memory of FFT() with a
+// zero-filled Idat.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_REAL_H
+#define FFT_REAL_H
+
+#include "fft_cpp.h"
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_Real.
+// PURPOSE:       Direct FFT of a real signal. Same scaling as FFT(): divided by N.
+//
+// PARAMETERS:
+//
+//    qint16 *Sig    [in]      - Real signal, N samples
+//    qint16 *Rdat   [out]     - Real part of the spectrum, bins 0 .. N/2 (N/2+1 entries)
+//    qint16 *Idat   [out]     - Imaginary part of the spectrum, bins 0 .. N/2
+//    int    N       [in]      - Number of samples: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_Real(const qint16 *Sig, qint16 *Rdat, qint16 *Idat, int N, int LogN);
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_RealInverse.
+// PURPOSE:       Inverse FFT of a Hermitian spectrum to a real signal. Same scaling as
+//                FFT(): not scaled.
+//
+// PARAMETERS:
+//
+//    qint16 *Rdat   [in, out] - Real part of the spectrum, bins 0 .. N/2; destroyed
+//    qint16 *Idat   [in, out] - Imaginary part of the spectrum, bins 0 .. N/2; destroyed
+//    qint16 *Sig    [out]     - Real signal, N samples
+//    int    N       [in]      - Number of samples: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_RealInverse(qint16 *Rdat, qint16 *Idat, qint16 *Sig, int N, int LogN);
+
+// For N = 4 .. 2**FFT_LOGN_MAX checks FFT_Real() of a random signal against bins
+// 0 .. N/2 of FFT() with a zero Idat, within 1 LSB, and FFT_RealInverse() of that spectrum
+// against the signal, within 6*sqrt(N) LSB. Prints one line; false on any failure.
+bool FFT_REAL_probe();
+
+#endif
@@ -0,0 +1,268 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Sliding DFT bank (see fft_sdft.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "fft_sdft.h"
+
+
+// W(j), j = 0 .. N-1, from the first stage table of the plan (j < N/2) and
+// W(j + N/2) = -W(j).
+static inline void Twiddle(const SDFT_BANK *Bank, int j, int32_t *wr, int32_t *wi)
+{
+  const int32_t Neg = -(int32_t)(j >> (Bank->LogN - 1));    // 0 or -1
+  const int     h   = j & ((Bank->N >> 1) - 1);
+
+  *wr = (Bank->Plan->Wr31[h] ^ Neg) - Neg;
+  *wi = (Bank->Plan->Wi31[h] ^ Neg) - Neg;
+}
+
+// (a*w + b*v) >> 31 without overflow for |a|, |b| < 2**62 and Q31 w, v: the high parts
+// of a and b are multiplied exactly, the low 31 bits separately.
+static inline int64_t DotQ31(int64_t a, int32_t w, int64_t b, int32_t v)
+{
+  const int64_t Lo = (a & 0x7FFFFFFF) * w + (b & 0x7FFFFFFF) * v;
+
+  return (a >> 31) * w + (b >> 31) * v + (Lo >> 31);
+}
+
+
+SDFT_BANK *SDFT_Create(int N, int LogN, const int *Bins, int Count)
+{
+  SDFT_BANK *Bank;
+  int        b;
+
+  // parameters error check:
+  if((Bins == NULL) || (Count < 1))                     return NULL;
+  if(!NUMBER_IS_2_POW_K(N))                             return NULL;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return NULL;
+  if(N != (1 << LogN))                                  return NULL;
+  for(b = 0; b < Count; b++)
+    if((Bins[b] < 0) || (Bins[b] >= N))                 return NULL;
+
+  Bank = (SDFT_BANK *)calloc(1, sizeof(SDFT_BANK));
+  if(Bank == NULL)                                      return NULL;
+
+  Bank->Plan  = FFT_GetPlan(N, FT_DIRECT);
+  Bank->N     = N;
+  Bank->LogN  = LogN;
+  Bank->Count = Count;
+  Bank->Bins  = (int *)malloc(Count * sizeof(int));
+  Bank->Phase = (int *)malloc(Count * sizeof(int));
+  Bank->Ar    = (int64_t *)malloc(Count * sizeof(int64_t));
+  Bank->Ai    = (int64_t *)malloc(Count * sizeof(int64_t));
+  Bank->Rhist = (qint16 *)malloc(N * sizeof(qint16));
+  Bank->Ihist = (qint16 *)malloc(N * sizeof(qint16));
+  if((Bank->Plan  == NULL) || (Bank->Bins  == NULL) || (Bank->Phase == NULL) ||
+     (Bank->Ar    == NULL) || (Bank->Ai    == NULL) || (Bank->Rhist == NULL) ||
+     (Bank->Ihist == NULL))
+  {
+    SDFT_Free(Bank);
+    return NULL;
+  }
+
+  memcpy(Bank->Bins, Bins, Count * sizeof(int));
+  SDFT_Reset(Bank);
+  return Bank;
+}
+
+void SDFT_Free(SDFT_BANK *Bank)
+{
+  if(Bank == NULL) return;
+
+  free(Bank->Bins);
+  free(Bank->Phase);
+  free(Bank->Ar);
+  free(Bank->Ai);
+  free(Bank->Rhist);
+  free(Bank->Ihist);
+  free(Bank);
+}
+
+void SDFT_Reset(SDFT_BANK *Bank)
+{
+  if(Bank == NULL) return;
+
+  memset(Bank->Phase, 0, Bank->Count * sizeof(int));
+  memset(Bank->Ar,    0, Bank->Count * sizeof(int64_t));
+  memset(Bank->Ai,    0, Bank->Count * sizeof(int64_t));
+  memset(Bank->Rhist, 0, Bank->N * sizeof(qint16));
+  memset(Bank->Ihist, 0, Bank->N * sizeof(qint16));
+  Bank->Pos = 0;
+}
+
+void SDFT_Update(SDFT_BANK *Bank, qint16 Re, qint16 Im)
+{
+  const int     Mask = Bank->N - 1;
+  const int64_t dr   = (int64_t)Re - Bank->Rhist[Bank->Pos];
+  const int64_t di   = (int64_t)Im - Bank->Ihist[Bank->Pos];
+  int32_t       wr, wi;
+  int           b;
+
+  Bank->Rhist[Bank->Pos] = Re;
+  Bank->Ihist[Bank->Pos] = Im;
+  Bank->Pos              = (Bank->Pos + 1) & Mask;
+
+  for(b = 0; b < Bank->Count; b++)
+  {
+    Twiddle(Bank, Bank->Phase[b], &wr, &wi);
+    Bank->Ar[b]   += dr * wr - di * wi;
+    Bank->Ai[b]   += dr * wi + di * wr;
+    Bank->Phase[b] = (Bank->Phase[b] + Bank->Bins[b]) & Mask;
+  }
+}
+
+bool SDFT_Push(SDFT_BANK *Bank, const qint16 *Rdat, const qint16 *Idat, int Count)
+{
+  int n;
+
+  // parameters error check:
+  if((Bank == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+  if(Count < 0)                                          return false;
+
+  for(n = 0; n < Count; n++)
+    SDFT_Update(Bank, Rdat[n], Idat[n]);
+
+  return true;
+}
+
+bool SDFT_ReadRaw(const SDFT_BANK *Bank, qint16 *Rbins, qint16 *Ibins)
+{
+  int32_t wr, wi;
+  int64_t yr, yi;
+  int     b;
+
+  // parameters error check:
+  if((Bank == NULL) || (Rbins == NULL) || (Ibins == NULL)) return false;
+
+  // Phase[b] is k*(n+1) mod N: rotation by conj(W) moves the origin to the oldest sample.
+  for(b = 0; b < Bank->Count; b++)
+  {
+    Twiddle(Bank, Bank->Phase[b], &wr, &wi);
+    yr       = DotQ31(Bank->Ar[b], wr, Bank->Ai[b],  wi);
+    yi       = DotQ31(Bank->Ai[b], wr, Bank->Ar[b], -wi);
+    Rbins[b] = (qint16)((yr + (1LL << 30)) >> 31);
+    Ibins[b] = (qint16)((yi + (1LL << 30)) >> 31);
+  }
+
+  return true;
+}
+
+bool SDFT_Read(const SDFT_BANK *Bank, qint16 *Rbins, qint16 *Ibins)
+{
+  int b;
+
+  if(!SDFT_ReadRaw(Bank, Rbins, Ibins)) return false;
+
+  for(b = 0; b < Bank->Count; b++)
+  {
+    Rbins[b] /= Bank->N;
+    Ibins[b] /= Bank->N;
+  }
+
+  return true;
+}
+
+
+bool SDFT_probe()
+{
+  const int  Nmax = 1 << FFT_LOGN_MAX, Len = 3 * Nmax + 123, Count = 4;
+  qint16    *Rsig = (qint16 *)malloc(Len * sizeof(qint16));
+  qint16    *Isig = (qint16 *)malloc(Len * sizeof(qint16));
+  qint16    *Rfft = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16    *Ifft = (qint16 *)malloc(Nmax * sizeof(qint16));
+  qint16     Rbins[Count], Ibins[Count], Rraw[Count], Iraw[Count];
+  uint32_t   Seed = 1;
+  int        LogN, n, b, Exact = 0, Total = 0;
+  bool       Ok = true;
+
+  if((Rsig == NULL) || (Isig == NULL) || (Rfft == NULL) || (Ifft == NULL))
+  {
+    printf("SDFT: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(n = 0; n < Len; n++)
+  {
+    Seed = Seed * 1664525u + 1013904223u;
+    Rsig[n] = (int16_t)(Seed >> 16);
+    Seed = Seed * 1664525u + 1013904223u;
+    Isig[n] = (int16_t)(Seed >> 16);
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+  {
+    const int   N    = 1 << LogN;
+    const int   L    = 3 * N + 123;               // Wraps the window three times.
+    const int   Bins[Count] = { 0, N / 2, N - 1, N - 3 };
+    SDFT_BANK  *Bank = SDFT_Create(N, LogN, Bins, Count);
+
+    if(Bank == NULL)
+    {
+      printf("SDFT: cannot create the bank at N=%d\n", N);
+      Ok = false;
+      break;
+    }
+
+    // Samples one by one, then in a block.
+    for(n = 0; n < N / 2; n++)
+      SDFT_Update(Bank, Rsig[n], Isig[n]);
+    SDFT_Push(Bank, Rsig + N / 2, Isig + N / 2, L - N / 2);
+    SDFT_Read(Bank, Rbins, Ibins);
+    SDFT_ReadRaw(Bank, Rraw, Iraw);
+    SDFT_Free(Bank);
+
+    memcpy(Rfft, Rsig + L - N, N * sizeof(qint16));
+    memcpy(Ifft, Isig + L - N, N * sizeof(qint16));
+    FFT(Rfft, Ifft, N, LogN, FT_DIRECT);
+
+    for(b = 0; (b < Count) && Ok; b++)
+    {
+      const int k  = Bins[b];
+      double    re = 0.0, im = 0.0, a;
+
+      // SDFT_Read() against FFT(): equal or 1 LSB off (see fft_sdft.h).
+      if((abs(Rbins[b] - Rfft[k]) > 1) || (abs(Ibins[b] - Ifft[k]) > 1))
+      {
+        printf("SDFT: bin %d differs from FFT() by more than 1 LSB at N=%d\n", k, N);
+        Ok = false;
+      }
+      Exact += (Rbins[b] == Rfft[k]) && (Ibins[b] == Ifft[k]);
+      Total++;
+
+      // SDFT_ReadRaw() against the DFT in double: rounded once, so within 1/2 LSB plus
+      // the error of the Q31 twiddles.
+      for(n = 0; n < N; n++)
+      {
+        a   = -2.0 * M_PI * (double)(((int64_t)k * n) & (N - 1)) / N;
+        re += Rsig[L - N + n] * cos(a) - Isig[L - N + n] * sin(a);
+        im += Rsig[L - N + n] * sin(a) + Isig[L - N + n] * cos(a);
+      }
+      if((fabs(Rraw[b] - re) > 0.51) || (fabs(Iraw[b] - im) > 0.51))
+      {
+        printf("SDFT: raw bin %d is not the rounded DFT at N=%d\n", k, N);
+        Ok = false;
+      }
+    }
+  }
+
+  if(Ok)
+    printf("SDFT: bins 0, N/2, N-1, N-3 after 3N+123 samples: %d of %d equal to FFT(), the "
+           "rest within 1 LSB; raw bins rounded DFT, N=4..%d\n", Exact, Total, Nmax);
+
+done:
+  free(Rsig);
+  free(Isig);
+  free(Rfft);
+  free(Ifft);
+  return Ok;
+}
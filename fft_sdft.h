@@ -0,0 +1,106 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Sliding DFT bank: a few bins of the N-point direct transform of the last N samples,
+// updated on every sample at O(1) cost per bin.
+//
+// The bank uses the modulated form of the sliding DFT. Bin k keeps
+//    A(k) = sum x(m) * W(k*m mod N)
+// over the window, with W(j) = exp(-2*pi*i * j/N) taken from the Q31 table of the direct
+// plan. A new sample x(n) adds (x(n) - x(n-N)) * W(k*n mod N): the sample leaving the
+// window had the same twiddle, as k*m mod N has period N. The products are exact and A(k)
+// is an int64 sum of them, so nothing is rounded until a bin is read. The bank cannot
+// drift or go unstable however long it runs. No twiddle is applied recursively, so there
+// is no pole to keep on the unit circle.
+//
+// Reading rotates A(k) by W(-k*(n+1)) to the window start. This gives the DFT of the last
+// N samples, oldest first, from the same Q31 twiddles as FFT(). SDFT_Read() scales it as
+// FFT() does (divided by N, truncated); SDFT_ReadRaw() rounds the unscaled value, giving
+// the correctly rounded DFT. FFT() rounds inside every butterfly and the bank only once, so
+// SDFT_Read() equals FFT() on nearly every bin of an aligned window and is 1 LSB off on the
+// rest. FFT_ExecutePlanRaw() differs from SDFT_ReadRaw() by its own rounding error. Until
+// N samples have been pushed, the window is padded with zeros at the front.
+//
+// Input range: |x| * N < 2**30 keeps every sum inside int64; FFT() itself needs
+// |x| * N < 2**31.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_SDFT_H
+#define FFT_SDFT_H
+
+#include <stdint.h>
+
+#include "fft_plan.h"
+
+typedef struct
+{
+  const FFT_PLAN *Plan;             // Direct plan of N points: the twiddles.
+  int             N;
+  int             LogN;
+  int             Count;            // Number of bins.
+  int            *Bins;             // Bin numbers, 0 .. N-1.
+  int            *Phase;            // k*n mod N of the next sample, per bin.
+  int64_t        *Ar;               // A(k), Q31.
+  int64_t        *Ai;
+  qint16         *Rhist;            // The last N samples, circular.
+  qint16         *Ihist;
+  int             Pos;              // n mod N of the next sample.
+} SDFT_BANK;
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          SDFT_Create.
+// PURPOSE:       Creates a bank of Count bins of an N-point window, all samples zero.
+//
+// PARAMETERS:
+//
+//    int    N       [in]      - Window length: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//    int    *Bins   [in]      - Bin numbers, 0 .. N-1 (negative frequencies as N-k)
+//    int    Count   [in]      - Number of bins, >= 1
+//
+// RETURN VALUE:  the bank (free with SDFT_Free), NULL on error.
+//_________________________________________________________________________________________
+
+SDFT_BANK *SDFT_Create(int N, int LogN, const int *Bins, int Count);
+
+void SDFT_Free(SDFT_BANK *Bank);
+
+// Clears the window and every bin.
+void SDFT_Reset(SDFT_BANK *Bank);
+
+// Slides the window by one sample.
+void SDFT_Update(SDFT_BANK *Bank, qint16 Re, qint16 Im);
+
+// Slides the window by Count samples.
+bool SDFT_Push(SDFT_BANK *Bank, const qint16 *Rdat, const qint16 *Idat, int Count);
+
+//_________________________________________________________________________________________
+//
+// NAME:          SDFT_Read, SDFT_ReadRaw.
+// PURPOSE:       Current value of every bin, in the order given to SDFT_Create():
+//                SDFT_Read() with the scaling of FFT() (divided by N), SDFT_ReadRaw()
+//                unscaled, as FFT_ExecutePlanRaw().
+//
+// PARAMETERS:
+//
+//    SDFT_BANK *Bank  [in]    - The bank
+//    qint16    *Rbins [out]   - Real parts, Count values
+//    qint16    *Ibins [out]   - Imaginary parts, Count values
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool SDFT_Read(const SDFT_BANK *Bank, qint16 *Rbins, qint16 *Ibins);
+
+bool SDFT_ReadRaw(const SDFT_BANK *Bank, qint16 *Rbins, qint16 *Ibins);
+
+// For N = 4 .. 2**FFT_LOGN_MAX pushes 3N + 123 random samples into a bank of the bins 0,
+// N/2, N-1 and N-3 and checks SDFT_Read() against FFT() of the last N samples (within
+// 1 LSB, see above) and SDFT_ReadRaw() against their DFT in double (within 0.51 LSB).
+// Prints one line; false on any failure.
+bool SDFT_probe();
+
+#endif
@@ -0,0 +1,203 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Compile-time specialised int engine for N = 4 .. 2**FFT_SMALL_LOGN_MAX.
+//
+// FFT_SMALL<LogN, Ft_Flag> runs the radix-4 DIF passes of FFT_ExecutePlanDif() with
+// every loop bound known at compile time, so the passes unroll. Its twiddle tables
+// are constexpr and built by the compiler with the rounding of the plan tables. The
+// bit-reverse permutation is a constexpr list of the index pairs to swap, with no
+// branches or searching. There is no plan lookup and no table load through a pointer.
+// Results are bit-identical to FFT_ExecutePlan(). FFT() dispatches its small sizes here.
+//
+// Twiddles come from an exact octant reduction of pi*p/q followed by Taylor series in
+// long double, with no libm, so any C++17 compiler can evaluate them.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_SMALL_H
+#define FFT_SMALL_H
+
+#include <stdint.h>
+
+#include "fft_plan.h"
+
+#define  FFT_SMALL_LOGN_MAX   8     // Largest N of the specialised engine is 256.
+
+
+//_________________________________________________________________________________________
+//
+// Tables.
+//_________________________________________________________________________________________
+
+// Same layout as the plan tables (FFT_STAGE_OFFSET) plus the swap list of the
+// bit-reverse permutation: points A[k] and B[k] trade places.
+template<int LogN>
+struct FFT_SMALL_TABLES
+{
+  static constexpr int N     = 1 << LogN;
+  static constexpr int Swaps = (N - (1 << ((LogN + 1) / 2))) / 2;   // Non-palindromes / 2.
+
+  int32_t   Wr[N], Wi[N];
+  int32_t   W3r[N], W3i[N];
+  uint16_t  A[Swaps], B[Swaps];
+};
+
+// cos and sin of pi*p/q (q a power of 2) into c and s.
+constexpr void FFT_SmallCosSin(int p, int q, long double &c, long double &s)
+{
+  const long double Pi  = 3.141592653589793238462643383279502884L;
+  long double       sc  = 1.0L, ss = 1.0L;    // Signs.
+  bool              Swap = false;
+
+  p %= 2 * q;
+  if(p >= q)     { p -= q; sc = -sc; ss = -ss; }            // pi + x
+  if(2 * p > q)  { p  = q - p; sc = -sc; }                  // pi - x
+  if(4 * p > q)  { p  = q - 2 * p; q *= 2; Swap = true; }   // pi/2 - x
+
+  const long double x  = Pi * p / q;                        // 0 .. pi/4
+  long double       tc = 1.0L, ts = x, vc = 1.0L, vs = x;
+  int               k = 0;
+
+  for(k = 1; k <= 14; k++)
+  {
+    tc *= -x * x / ((2 * k - 1) * (2 * k));
+    ts *= -x * x / ((2 * k) * (2 * k + 1));
+    vc += tc;
+    vs += ts;
+  }
+
+  c = sc * (Swap ? vs : vc);
+  s = ss * (Swap ? vc : vs);
+}
+
+// FFT_TwiddleQ31() at compile time.
+constexpr int32_t FFT_SmallQ31(long double x)
+{
+  const long double t = x * 2147483648.0L + 0.5L;
+  int64_t           v = (int64_t)t;
+
+  if((long double)v > t) v--;                               // floor
+  if(v >  Q31_ONE) v =  Q31_ONE;
+  if(v < -Q31_ONE) v = -Q31_ONE;
+  return (int32_t)v;
+}
+
+template<int LogN>
+constexpr FFT_SMALL_TABLES<LogN> FFT_SmallMakeTables(int Ft_Flag)
+{
+  FFT_SMALL_TABLES<LogN> T{};
+  const int              N = 1 << LogN;
+  long double            c = 0.0L, s = 0.0L;
+  int                    in = 0, j = 0, i = 0, b = 0, r = 0, k = 0;
+
+  for(in = N >> 1; in > 0; in >>= 1)
+  {
+    for(j = 0; j < in; j++)
+    {
+      FFT_SmallCosSin(j, in, c, s);
+      T.Wr[FFT_STAGE_OFFSET(N, in) + j] = FFT_SmallQ31(c);
+      T.Wi[FFT_STAGE_OFFSET(N, in) + j] = FFT_SmallQ31(Ft_Flag * s);
+    }
+    for(j = 0; j < in / 2; j++)
+    {
+      FFT_SmallCosSin(3 * j, in, c, s);
+      T.W3r[FFT_STAGE_OFFSET(N, in) + j] = FFT_SmallQ31(c);
+      T.W3i[FFT_STAGE_OFFSET(N, in) + j] = FFT_SmallQ31(Ft_Flag * s);
+    }
+  }
+
+  for(i = 0; i < N; i++)
+  {
+    for(r = 0, b = 0; b < LogN; b++)
+      r |= ((i >> b) & 1) << (LogN - 1 - b);
+    if(i < r)
+    {
+      T.A[k] = (uint16_t)i;
+      T.B[k] = (uint16_t)r;
+      k++;
+    }
+  }
+
+  return T;
+}
+
+
+//_________________________________________________________________________________________
+//
+// Engine.
+//_________________________________________________________________________________________
+
+template<int LogN, int Ft_Flag>
+struct FFT_SMALL
+{
+  static constexpr int                    N = 1 << LogN;
+  static constexpr FFT_SMALL_TABLES<LogN> T = FFT_SmallMakeTables<LogN>(Ft_Flag);
+
+  // The radix-4 pass over the span Ie, then the following passes.
+  template<int Ie>
+  static inline void Pass4(qint16 *Rdat, qint16 *Idat)
+  {
+    constexpr int      q = Ie >> 2;
+    const FFT_INT_OPS  Op;
+    int                g, j;
+
+    for(g = 0; g < N; g += Ie)
+    {
+      qint16 *R0 = Rdat + g, *R1 = R0 + q, *R2 = R1 + q, *R3 = R2 + q;
+      qint16 *I0 = Idat + g, *I1 = I0 + q, *I2 = I1 + q, *I3 = I2 + q;
+
+      for(j = 0; j < q; j++)
+      {
+        const int32_t w1r = T.Wr[FFT_STAGE_OFFSET(N, 2*q) + j],  w1i = T.Wi[FFT_STAGE_OFFSET(N, 2*q) + j];
+        const int32_t w2r = T.Wr[FFT_STAGE_OFFSET(N, q) + j],    w2i = T.Wi[FFT_STAGE_OFFSET(N, q) + j];
+        const int32_t w3r = T.W3r[FFT_STAGE_OFFSET(N, 2*q) + j], w3i = T.W3i[FFT_STAGE_OFFSET(N, 2*q) + j];
+
+        FFT_Radix4Dif(Op, Ft_Flag, R0[j], I0[j], R1[j], I1[j], R2[j], I2[j], R3[j], I3[j],
+                      w1r, w1i, w2r, w2i, w3r, w3i);
+      }
+    }
+
+    if constexpr (Ie >= 16) Pass4<(Ie >> 2)>(Rdat, Idat);
+  }
+
+  // In-place transform with the scaling and order of FFT_ExecutePlan().
+  static void Execute(qint16 *Rdat, qint16 *Idat)
+  {
+    int     i;
+    qint16  rtp, itp;
+
+    Pass4<N>(Rdat, Idat);
+
+    // Odd LogN: the radix-2 stage with the half-span 1.
+    if constexpr ((LogN & 1) != 0)
+      for(i = 0; i < N; i += 2)
+      {
+        rtp       = Rdat[i] + Rdat[i + 1];
+        itp       = Idat[i] + Idat[i + 1];
+        Rdat[i+1] = Rdat[i] - Rdat[i + 1];
+        Idat[i+1] = Idat[i] - Idat[i + 1];
+        Rdat[i]   = rtp;
+        Idat[i]   = itp;
+      }
+
+    for(i = 0; i < T.Swaps; i++)
+    {
+      rtp             = Rdat[T.B[i]];
+      itp             = Idat[T.B[i]];
+      Rdat[T.B[i]]    = Rdat[T.A[i]];
+      Idat[T.B[i]]    = Idat[T.A[i]];
+      Rdat[T.A[i]]    = rtp;
+      Idat[T.A[i]]    = itp;
+    }
+
+    if constexpr (Ft_Flag == FT_DIRECT)
+      for(i = 0; i < N; i++)
+      {
+        Rdat[i] /= N;
+        Idat[i] /= N;
+      }
+  }
+};
+
+#endif
@@ -0,0 +1,292 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Sample-type-generic engine: entry points (see fft_type.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fft_type.h"
+
+
+// Counting instantiation when Stats is given (and compiled in), the plain one otherwise.
+// For FFT_Q31 the plain one is FFT_ExecutePlan().
+template<class T>
+static bool Execute(const FFT_PLAN *Plan, typename T::Sample *Rdat, typename T::Sample *Idat,
+                    FFT_STATS *Stats)
+{
+  // parameters error check:
+  if((Plan == NULL) || (Rdat == NULL) || (Idat == NULL)) return false;
+
+#if FFT_STATS_ENABLE
+  if((Stats != NULL) && Stats->CyclesOnly)
+  {
+    FFT_ENGINE<T, FFT_COUNT_CYCLES>::Execute(Plan, Rdat, Idat, Stats);
+    return true;
+  }
+  if(Stats != NULL)
+  {
+    FFT_ENGINE<T, FFT_COUNT_RANGES>::Execute(Plan, Rdat, Idat, Stats);
+    return true;
+  }
+#endif
+
+  FFT_ENGINE<T, FFT_COUNT_NONE>::Execute(Plan, Rdat, Idat, NULL);
+  return true;
+}
+
+
+bool FFT_ExecutePlanQ15(const FFT_PLAN *Plan, int16_t *Rdat, int16_t *Idat, FFT_STATS *Stats)
+{
+  return Execute<FFT_Q15>(Plan, Rdat, Idat, Stats);
+}
+
+bool FFT_ExecutePlanQ31(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, FFT_STATS *Stats)
+{
+  return Execute<FFT_Q31>(Plan, Rdat, Idat, Stats);
+}
+
+bool FFT_ExecutePlanF32(const FFT_PLAN *Plan, float *Rdat, float *Idat, FFT_STATS *Stats)
+{
+  return Execute<FFT_F32>(Plan, Rdat, Idat, Stats);
+}
+
+bool FFT_ExecutePlanTyped(const FFT_PLAN *Plan, int Type, void *Rdat, void *Idat, FFT_STATS *Stats)
+{
+  switch(Type)
+  {
+    case FFT_TYPE_Q15: return FFT_ExecutePlanQ15(Plan, (int16_t *)Rdat, (int16_t *)Idat, Stats);
+    case FFT_TYPE_Q31: return FFT_ExecutePlanQ31(Plan, (qint16 *)Rdat,  (qint16 *)Idat,  Stats);
+    case FFT_TYPE_F32: return FFT_ExecutePlanF32(Plan, (float *)Rdat,   (float *)Idat,   Stats);
+  }
+
+  return false;
+}
+
+void FFT_StatsReset(FFT_STATS *Stats, bool CyclesOnly)
+{
+  if(Stats == NULL) return;
+
+  memset(Stats, 0, sizeof(FFT_STATS));
+  Stats->CyclesOnly = CyclesOnly;
+}
+
+
+
+// Runs Src through every instantiation of type T: the wrapper with Stats == NULL (result
+// in Rout/Iout), the plain engine handed a cleared FFT_STATS, and the wrapper counting
+// cycles and ranges. False unless all four results are identical, the plain engine left
+// its FFT_STATS untouched and the counting ones recorded one call of every stage.
+// Clipped gets the overflows and saturations of the ranges run.
+template<class T>
+static bool ProbeRun(const FFT_PLAN *Plan, const typename T::Sample *Rsrc,
+                     const typename T::Sample *Isrc, typename T::Sample *Rout,
+                     typename T::Sample *Iout, typename T::Sample *Rtmp,
+                     typename T::Sample *Itmp, uint64_t *Clipped)
+{
+  const size_t Size = Plan->N * sizeof(typename T::Sample);
+  FFT_STATS    Stats, Zero;
+  int          m, k;
+  bool         Ok = true;
+
+  memcpy(Rout, Rsrc, Size);
+  memcpy(Iout, Isrc, Size);
+  Execute<T>(Plan, Rout, Iout, NULL);
+
+  FFT_StatsReset(&Zero, false);
+  *Clipped = 0;
+
+  for(m = 0; m < 3; m++)
+  {
+    memcpy(Rtmp, Rsrc, Size);
+    memcpy(Itmp, Isrc, Size);
+    FFT_StatsReset(&Stats, m == 1);
+
+    if(m == 0)
+    {
+      FFT_ENGINE<T, FFT_COUNT_NONE>::Execute(Plan, Rtmp, Itmp, &Stats);
+      Ok = Ok && !memcmp(&Stats, &Zero, sizeof(FFT_STATS));
+    }
+    else
+    {
+      Execute<T>(Plan, Rtmp, Itmp, &Stats);
+#if FFT_STATS_ENABLE
+      // Radix-4 passes, the radix-2 stage of odd LogN and the reorder.
+      Ok = Ok && (Stats.Calls == 1) &&
+           (Stats.Stages == Plan->LogN / 2 + (Plan->LogN & 1) + 1);
+#endif
+    }
+
+    if(m == 2)
+      for(k = 0; k < FFT_STATS_STAGES; k++)
+        *Clipped += Stats.Overflow[k] + Stats.Saturation[k];
+
+    Ok = Ok && !memcmp(Rtmp, Rout, Size) && !memcmp(Itmp, Iout, Size);
+  }
+
+  return Ok;
+}
+
+bool FFT_TYPE_probe()
+{
+  const int  Nmax  = 1 << FFT_LOGN_MAX;
+  const int  Range = 23000;                    // Q15 input that cannot saturate.
+  qint16    *Buf31 = (qint16 *)malloc(8 * Nmax * sizeof(qint16));
+  int16_t   *Buf15 = (int16_t *)malloc(6 * Nmax * sizeof(int16_t));
+  float     *BufF  = (float *)malloc(6 * Nmax * sizeof(float));
+  qint16    *R31   = Buf31,            *I31  = Buf31 + Nmax;       // Input.
+  qint16    *Rexp  = Buf31 + 2 * Nmax, *Iexp = Buf31 + 3 * Nmax;   // Int engine.
+  qint16    *Rout  = Buf31 + 4 * Nmax, *Iout = Buf31 + 5 * Nmax;
+  qint16    *Rtmp  = Buf31 + 6 * Nmax, *Itmp = Buf31 + 7 * Nmax;
+  int16_t   *R15   = Buf15,            *I15  = Buf15 + Nmax;
+  int16_t   *Rq    = Buf15 + 2 * Nmax, *Iq   = Buf15 + 3 * Nmax;
+  int16_t   *Rq2   = Buf15 + 4 * Nmax, *Iq2  = Buf15 + 5 * Nmax;
+  float     *RF    = BufF,             *IF   = BufF + Nmax;
+  float     *Rf    = BufF + 2 * Nmax,  *If   = BufF + 3 * Nmax;
+  float     *Rf2   = BufF + 4 * Nmax,  *If2  = BufF + 5 * Nmax;
+  uint32_t   Seed  = 1;
+  uint64_t   Clipped;
+  int        LogN, d, n;
+  double     Err[4] = { 0.0, 0.0, 0.0, 0.0 };  // Q15, F32 direct; Q15, F32 inverse.
+  bool       Ok = true;
+
+  if((Buf31 == NULL) || (Buf15 == NULL) || (BufF == NULL))
+  {
+    printf("TYPE: out of memory\n");
+    Ok = false;
+    goto done;
+  }
+
+  for(LogN = 2; (LogN <= FFT_LOGN_MAX) && Ok; LogN++)
+  {
+    const int       N       = 1 << LogN;
+    const FFT_PLAN *Direct  = FFT_GetPlan(N, FT_DIRECT);
+    const FFT_PLAN *Inverse = FFT_GetPlan(N, FT_INVERSE);
+
+    // In LSB, against the int engine. Q15 direct: every radix-2 level halves, rounded.
+    // F32 direct: the reference itself is off by a few LSB of a result N times larger.
+    // Q15 inverse: the Q15 twiddle error grows with the unscaled output. F32 inverse:
+    // the round trip back to the input.
+    const double    Bound[4] = { (LogN + 2) / 2.0, 0.25, sqrt((double)N) / 2.0 + 2.0, 0.05 };
+
+    if((Direct == NULL) || (Inverse == NULL))
+    {
+      printf("TYPE: no plan for N=%d\n", N);
+      Ok = false;
+      break;
+    }
+
+    for(n = 0; n < N; n++)
+    {
+      Seed   = Seed * 1664525u + 1013904223u;
+      R31[n] = R15[n] = (int16_t)((int)((Seed >> 8) % (2 * Range + 1)) - Range);
+      Seed   = Seed * 1664525u + 1013904223u;
+      I31[n] = I15[n] = (int16_t)((int)((Seed >> 8) % (2 * Range + 1)) - Range);
+      RF[n]  = R31[n];
+      IF[n]  = I31[n];
+    }
+
+    // Q31, both directions: FFT_ExecutePlan() with and without counters.
+    for(d = 0; (d < 2) && Ok; d++)
+    {
+      const FFT_PLAN *Plan = d ? Inverse : Direct;
+
+      memcpy(Rexp, R31, N * sizeof(qint16));
+      memcpy(Iexp, I31, N * sizeof(qint16));
+      FFT_ExecutePlan(Plan, Rexp, Iexp);
+
+      if(!ProbeRun<FFT_Q31>(Plan, R31, I31, Rout, Iout, Rtmp, Itmp, &Clipped) ||
+         (Clipped != 0) || memcmp(Rout, Rexp, N * sizeof(qint16)) ||
+         memcmp(Iout, Iexp, N * sizeof(qint16)))
+      {
+        printf("TYPE: Q31 differs from FFT_ExecutePlan() at N=%d, %s\n",
+               N, d ? "inverse" : "direct");
+        Ok = false;
+      }
+    }
+    if(!Ok) break;
+
+    // Q15 and F32 direct, against the int engine without the division by N.
+    memcpy(Rexp, R31, N * sizeof(qint16));
+    memcpy(Iexp, I31, N * sizeof(qint16));
+    FFT_ExecutePlanRaw(Direct, Rexp, Iexp);
+
+    if(!ProbeRun<FFT_Q15>(Direct, R15, I15, Rq, Iq, Rq2, Iq2, &Clipped) || (Clipped != 0) ||
+       !ProbeRun<FFT_F32>(Direct, RF, IF, Rf, If, Rf2, If2, &Clipped) || (Clipped != 0))
+    {
+      printf("TYPE: Q15 or F32 counters or results differ at N=%d, direct\n", N);
+      Ok = false;
+      break;
+    }
+
+    for(n = 0; n < N; n++)
+    {
+      Err[0] = fmax(Err[0], fmax(fabs(Rq[n] - Rexp[n] / (double)N),
+                                 fabs(Iq[n] - Iexp[n] / (double)N)) / Bound[0]);
+      Err[1] = fmax(Err[1], fmax(fabs(Rf[n] - Rexp[n] / (double)N),
+                                 fabs(If[n] - Iexp[n] / (double)N)) / Bound[1]);
+    }
+
+    // The inverse of those spectra: Q15 against the int engine, F32 against the input.
+    for(n = 0; n < N; n++)
+    {
+      Rexp[n] = R15[n] = Rq[n];
+      Iexp[n] = I15[n] = Iq[n];
+      RF[n]   = Rf[n];
+      IF[n]   = If[n];
+    }
+    FFT_ExecutePlan(Inverse, Rexp, Iexp);
+
+    if(!ProbeRun<FFT_Q15>(Inverse, R15, I15, Rq, Iq, Rq2, Iq2, &Clipped) || (Clipped != 0) ||
+       !ProbeRun<FFT_F32>(Inverse, RF, IF, Rf, If, Rf2, If2, &Clipped) || (Clipped != 0))
+    {
+      printf("TYPE: Q15 or F32 counters or results differ at N=%d, inverse\n", N);
+      Ok = false;
+      break;
+    }
+
+    for(n = 0; n < N; n++)
+    {
+      Err[2] = fmax(Err[2], fmax(abs(Rq[n] - Rexp[n]), abs(Iq[n] - Iexp[n])) / Bound[2]);
+      Err[3] = fmax(Err[3], fmax(fabs(Rf[n] - R31[n]), fabs(If[n] - I31[n])) / Bound[3]);
+    }
+
+    if((Err[0] > 1.0) || (Err[1] > 1.0) || (Err[2] > 1.0) || (Err[3] > 1.0))
+    {
+      printf("TYPE: error above the bound at N=%d (%.2f, %.2f, %.2f, %.2f of it)\n",
+             N, Err[0], Err[1], Err[2], Err[3]);
+      Ok = false;
+    }
+  }
+  if(!Ok) goto done;
+
+#if FFT_STATS_ENABLE
+  // And the counters do see saturation: alternating full scale at N = 1024.
+  for(n = 0; n < 1024; n++)
+  {
+    R15[n] = (n & 1) ? -32768 : 32767;
+    I15[n] = 0;
+  }
+  Ok = ProbeRun<FFT_Q15>(FFT_GetPlan(1024, FT_DIRECT), R15, I15, Rq, Iq, Rq2, Iq2, &Clipped) &&
+       (Clipped != 0);
+  if(!Ok)
+  {
+    printf("TYPE: Q15 saturation not counted\n");
+    goto done;
+  }
+#endif
+
+  printf("TYPE: Q31 bit-identical to FFT_ExecutePlan(), plain engines count nothing; Q15, "
+         "F32 at %.2f, %.2f (direct) and %.2f, %.2f (inverse) of their bounds, N=4..%d\n",
+         Err[0], Err[1], Err[2], Err[3], Nmax);
+
+done:
+  free(Buf31);
+  free(Buf15);
+  free(BufF);
+  return Ok;
+}
@@ -0,0 +1,453 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Sample-type-generic int/float engine with optional per-stage counters.
+//
+// FFT_ENGINE<T, Count> runs the radix-4 DIF passes of FFT_ExecutePlanDif(), the shared
+// FFT_Radix4Dif() butterfly, over the sample type of a traits class T. It reads its
+// twiddles from the plan tables of that type, so one plan serves every type:
+//    FFT_Q15 - int16_t samples, int32_t sums, Q15 twiddles. In the direct transform every
+//              radix-2 level halves its sums (rounded), so the division by N is spread
+//              over the passes. Halving keeps the modulus of a point from growing, but
+//              not its components: a twiddle product can turn |re|, |im| <= 2**15 into a
+//              component of 2**15 * sqrt(2). Input with |re|, |im| <= 23000 (moduli below
+//              2**15, less a margin for rounding) cannot saturate; larger input can, e.g.
+//              N = 1024 with alternating +32767 and -32768. The inverse transform is not
+//              scaled. Results saturate to int16.
+//    FFT_Q31 - qint16 samples, Q31 twiddles: the engine of FFT(). Uncounted, or counting
+//              cycles only, it is FFT_ExecutePlan() itself.
+//    FFT_F32 - float samples and twiddles; the direct transform is multiplied by 1/N.
+// The scaling and the natural output order are those of FFT_ExecutePlan().
+//
+// Counters are kept per stage: one entry per radix-4 pass, one for the radix-2 stage of
+// odd LogN, and the last for the reorder and the final scaling.
+//    Cycles     - time stamp counter ticks (x86 TSC, ARMv8 virtual counter, else ns)
+//    Overflow   - values that did not fit the sample type: the butterfly sums as well
+//                 as the stored results; for float, results that are not finite
+//    Saturation - values clamped to the sample range (saturating types only)
+// Count selects what is kept: FFT_COUNT_NONE, FFT_COUNT_CYCLES (the plain passes, with
+// the counter read between stages) or FFT_COUNT_RANGES (every value checked as well,
+// which makes the passes slower: their Cycles include the checks). All three
+// instantiations are compiled in, and the wrappers of fft_type.c select one at run time
+// from the FFT_STATS pointer and its CyclesOnly flag. Measuring needs no rebuild, and the
+// plain path carries no counting code. Building with FFT_STATS_ENABLE 0 drops the
+// counting instantiations and ignores Stats.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef FFT_TYPE_H
+#define FFT_TYPE_H
+
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "fft_plan.h"
+#include "fft_order.h"
+
+#ifndef FFT_STATS_ENABLE
+#define  FFT_STATS_ENABLE     1
+#endif
+
+#define  FFT_TYPE_Q15         1
+#define  FFT_TYPE_Q31         2
+#define  FFT_TYPE_F32         3
+
+#define  FFT_COUNT_NONE       0     // Plain passes.
+#define  FFT_COUNT_CYCLES     1     // Plain passes, timed per stage.
+#define  FFT_COUNT_RANGES     2     // Timed, every value checked.
+
+#define  FFT_STATS_STAGES     (FFT_LOGN_MAX / 2 + 2)   // Radix-4 passes, radix-2, reorder.
+
+// Accumulates over calls; clear and select the counters with FFT_StatsReset().
+typedef struct
+{
+  bool      CyclesOnly;                       // FFT_COUNT_CYCLES, else FFT_COUNT_RANGES.
+  uint64_t  Calls;
+  int       Stages;                           // Entries used: passes + (LogN odd) + 1.
+  uint64_t  Cycles[FFT_STATS_STAGES];
+  uint64_t  Overflow[FFT_STATS_STAGES];
+  uint64_t  Saturation[FFT_STATS_STAGES];
+} FFT_STATS;
+
+static inline uint64_t FFT_Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t t;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(t));
+  return t;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+#endif
+}
+
+// Counts of one stage, kept in registers while it runs.
+typedef struct
+{
+  uint64_t  Overflow;
+  uint64_t  Saturation;
+} FFT_STAGE_COUNT;
+
+
+//_________________________________________________________________________________________
+//
+// Sample types.
+//
+//    Sample, Twiddle      - stored value, twiddle factor
+//    Acc                  - butterfly sum wide enough to see every overflow (counting)
+//    Sum                  - butterfly sum of the plain engine
+//    Halve                - true: every radix-2 level of the direct transform halves
+//    Wr() .. W3i()        - the plan tables of the type
+//    Shift(x, s)          - x / 2**s, rounded (s = 0 or 1)
+//    MulRe/MulIm(a, b, wr, wi) - (a + i*b) * (wr + i*wi), rounded to the sample scale
+//    Narrow<Count>(x, c)  - x as a Sample, counted in c
+//    Scale(x, N)          - final division of the direct transform, if not Halve
+//_________________________________________________________________________________________
+
+struct FFT_Q15
+{
+  typedef int16_t  Sample;
+  typedef int32_t  Acc;
+  typedef int32_t  Sum;
+  typedef int16_t  Twiddle;
+  static const int  Type  = FFT_TYPE_Q15;
+  static const bool Halve = true;
+
+  static const Twiddle *Wr(const FFT_PLAN *P)  { return P->Wr15; }
+  static const Twiddle *Wi(const FFT_PLAN *P)  { return P->Wi15; }
+  static const Twiddle *W3r(const FFT_PLAN *P) { return P->W3r15; }
+  static const Twiddle *W3i(const FFT_PLAN *P) { return P->W3i15; }
+
+  static Acc Shift(Acc x, int s) { return (x + s) >> s; }
+  static Acc MulRe(Sample a, Sample b, Twiddle wr, Twiddle wi)
+  {
+    return ((Acc)a * wr - (Acc)b * wi + 0x4000) >> 15;
+  }
+  static Acc MulIm(Sample a, Sample b, Twiddle wr, Twiddle wi)
+  {
+    return ((Acc)b * wr + (Acc)a * wi + 0x4000) >> 15;
+  }
+
+  template<bool Count>
+  static Sample Narrow(Acc x, FFT_STAGE_COUNT *c)
+  {
+    if((x > INT16_MAX) || (x < INT16_MIN))
+    {
+      if(Count)
+      {
+        c->Overflow++;
+        c->Saturation++;
+      }
+      return (x > 0) ? INT16_MAX : INT16_MIN;
+    }
+    return (Sample)x;
+  }
+
+  static Sample Scale(Sample x, int) { return x; }
+};
+
+struct FFT_Q31
+{
+  typedef qint16   Sample;
+  typedef int64_t  Acc;
+  typedef qint16   Sum;                       // FFT_INT_OPS, see FFT_TYPE_OPS.
+  typedef int32_t  Twiddle;
+  static const int  Type  = FFT_TYPE_Q31;
+  static const bool Halve = false;
+
+  static const Twiddle *Wr(const FFT_PLAN *P)  { return P->Wr31; }
+  static const Twiddle *Wi(const FFT_PLAN *P)  { return P->Wi31; }
+  static const Twiddle *W3r(const FFT_PLAN *P) { return P->W3r31; }
+  static const Twiddle *W3i(const FFT_PLAN *P) { return P->W3i31; }
+
+  static Acc Shift(Acc x, int) { return x; }
+  // Q31_CMUL_RE/IM before their cast, so that an overflow can be counted.
+  static Acc MulRe(Sample a, Sample b, Twiddle wr, Twiddle wi)
+  {
+    return ((Acc)a * wr - (Acc)b * wi + (1LL << 30)) >> 31;
+  }
+  static Acc MulIm(Sample a, Sample b, Twiddle wr, Twiddle wi)
+  {
+    return ((Acc)b * wr + (Acc)a * wi + (1LL << 30)) >> 31;
+  }
+
+  // Wraps like the int arithmetic of FFT().
+  template<bool Count>
+  static Sample Narrow(Acc x, FFT_STAGE_COUNT *c)
+  {
+    if(Count && ((x > INT32_MAX) || (x < INT32_MIN))) c->Overflow++;
+    return (Sample)(uint32_t)x;
+  }
+
+  static Sample Scale(Sample x, int N) { return x / N; }
+};
+
+struct FFT_F32
+{
+  typedef float    Sample;
+  typedef float    Acc;
+  typedef float    Sum;
+  typedef float    Twiddle;
+  static const int  Type  = FFT_TYPE_F32;
+  static const bool Halve = false;
+
+  static const Twiddle *Wr(const FFT_PLAN *P)  { return P->WrF; }
+  static const Twiddle *Wi(const FFT_PLAN *P)  { return P->WiF; }
+  static const Twiddle *W3r(const FFT_PLAN *P) { return P->W3rF; }
+  static const Twiddle *W3i(const FFT_PLAN *P) { return P->W3iF; }
+
+  static Acc Shift(Acc x, int) { return x; }
+  static Acc MulRe(Sample a, Sample b, Twiddle wr, Twiddle wi) { return a * wr - b * wi; }
+  static Acc MulIm(Sample a, Sample b, Twiddle wr, Twiddle wi) { return b * wr + a * wi; }
+
+  template<bool Count>
+  static Sample Narrow(Acc x, FFT_STAGE_COUNT *c)
+  {
+    if(Count && !isfinite(x)) c->Overflow++;
+    return x;
+  }
+
+  static Sample Scale(Sample x, int N) { return x * (1.0f / N); }
+};
+
+
+//_________________________________________________________________________________________
+//
+// Butterfly operations (see FFT_Radix4Dif): sums in Acc (Ranges) or Sum, divided by 2**s
+// and narrowed to Sample, products rounded and narrowed. With Ranges every narrowing is
+// counted in c.
+//_________________________________________________________________________________________
+
+template<class T, bool Ranges>
+struct FFT_TYPE_OPS
+{
+  typedef typename T::Sample   Sample;
+  typedef typename T::Twiddle  Twiddle;
+  typedef typename std::conditional<Ranges, typename T::Acc, typename T::Sum>::type  A;
+
+  const int         s;
+  FFT_STAGE_COUNT  *c;
+
+  FFT_TYPE_OPS(int Shift, FFT_STAGE_COUNT *Count) : s(Shift), c(Count) {}
+
+  FFT_INLINE Sample Add(Sample a, Sample b) const
+  {
+    return T::template Narrow<Ranges>(T::Shift((A)a + b, s), c);
+  }
+  FFT_INLINE Sample Sub(Sample a, Sample b) const
+  {
+    return T::template Narrow<Ranges>(T::Shift((A)a - b, s), c);
+  }
+  FFT_INLINE Sample Rot(int Ft, Sample a, Sample b) const
+  {
+    return T::template Narrow<Ranges>(T::Shift(Ft * ((A)a - b), s), c);
+  }
+  FFT_INLINE Sample MulRe(Sample a, Sample b, Twiddle wr, Twiddle wi) const
+  {
+    return T::template Narrow<Ranges>(T::MulRe(a, b, wr, wi), c);
+  }
+  FFT_INLINE Sample MulIm(Sample a, Sample b, Twiddle wr, Twiddle wi) const
+  {
+    return T::template Narrow<Ranges>(T::MulIm(a, b, wr, wi), c);
+  }
+};
+
+// Unchecked FFT_Q31 is the arithmetic of FFT() (it never shifts).
+template<>
+struct FFT_TYPE_OPS<FFT_Q31, false> : FFT_INT_OPS
+{
+  FFT_TYPE_OPS(int, FFT_STAGE_COUNT *) {}
+};
+
+
+//_________________________________________________________________________________________
+//
+// Engine.
+//_________________________________________________________________________________________
+
+template<class T, int Count>
+struct FFT_ENGINE
+{
+  typedef typename T::Sample                          S;
+  typedef typename T::Twiddle                         W;
+  typedef FFT_TYPE_OPS<T, Count == FFT_COUNT_RANGES>  OPS;
+
+  // One radix-4 pass over the span ie (see FFT_Radix4Dif).
+  static void Pass4(const FFT_PLAN *Plan, int ie, const OPS &Op, S *Rdat, S *Idat)
+  {
+    const int  N   = Plan->N;
+    const int  Ft  = Plan->Ft_Flag;
+    const int  q   = ie >> 2;
+    const W   *W1r = T::Wr(Plan)  + FFT_STAGE_OFFSET(N, 2*q);
+    const W   *W1i = T::Wi(Plan)  + FFT_STAGE_OFFSET(N, 2*q);
+    const W   *W2r = T::Wr(Plan)  + FFT_STAGE_OFFSET(N, q);
+    const W   *W2i = T::Wi(Plan)  + FFT_STAGE_OFFSET(N, q);
+    const W   *W3r = T::W3r(Plan) + FFT_STAGE_OFFSET(N, 2*q);
+    const W   *W3i = T::W3i(Plan) + FFT_STAGE_OFFSET(N, 2*q);
+    int        g, j;
+
+    for(g = 0; g < N; g += ie)
+    {
+      S *R0 = Rdat + g, *R1 = R0 + q, *R2 = R1 + q, *R3 = R2 + q;
+      S *I0 = Idat + g, *I1 = I0 + q, *I2 = I1 + q, *I3 = I2 + q;
+
+      for(j = 0; j < q; j++)
+        FFT_Radix4Dif(Op, Ft, R0[j], I0[j], R1[j], I1[j], R2[j], I2[j], R3[j], I3[j],
+                      W1r[j], W1i[j], W2r[j], W2i[j], W3r[j], W3i[j]);
+    }
+  }
+
+  // The radix-2 stage with the half-span 1 (odd LogN); its only twiddle is 1.
+  static void Pass2(int N, const OPS &Op, S *Rdat, S *Idat)
+  {
+    int  i;
+    S    rtp, itp;
+
+    for(i = 0; i < N; i += 2)
+    {
+      rtp       = Op.Add(Rdat[i], Rdat[i + 1]);
+      itp       = Op.Add(Idat[i], Idat[i + 1]);
+      Rdat[i+1] = Op.Sub(Rdat[i], Rdat[i + 1]);
+      Idat[i+1] = Op.Sub(Idat[i], Idat[i + 1]);
+      Rdat[i]   = rtp;
+      Idat[i]   = itp;
+    }
+  }
+
+  // The butterfly passes alone, output bit-reversed (FFT_ExecutePlanDif). In the direct
+  // transform of a halving type every radix-2 level divides by 2. Returns the number of
+  // stages recorded in Stats.
+  static int Passes(const FFT_PLAN *Plan, S *Rdat, S *Idat, FFT_STATS *Stats)
+  {
+    const int        N  = Plan->N;
+    FFT_STAGE_COUNT  c  = { 0, 0 };
+    const OPS        Op((T::Halve && (Plan->Ft_Flag == FT_DIRECT)) ? 1 : 0, &c);
+    uint64_t         t0 = 0;
+    int              ie, k = 0;
+
+    if(Count) t0 = FFT_Ticks();
+
+    for(ie = N; ie >= 4; ie >>= 2, k++)
+    {
+      Pass4(Plan, ie, Op, Rdat, Idat);
+      if(Count) Record(Stats, k, &c, &t0);
+    }
+
+    if(ie == 2)
+    {
+      Pass2(N, Op, Rdat, Idat);
+      if(Count) Record(Stats, k++, &c, &t0);
+    }
+
+    return k;
+  }
+
+  static void Reorder(const FFT_PLAN *Plan, S *Rdat, S *Idat)
+  {
+    const int  N = Plan->N;
+    int        i, io;
+    S          t;
+
+    // qint16 data take the blocked (COBRA) permutation of large N.
+    if constexpr (T::Type == FFT_TYPE_Q31)
+      FFT_BitReverse(Plan, Rdat, Idat);
+    else
+      for(i = 1; i < N - 1; i++)
+      {
+        io = Plan->Rev[i];
+        if(i < io)
+        {
+          t        = Rdat[io];
+          Rdat[io] = Rdat[i];
+          Rdat[i]  = t;
+          t        = Idat[io];
+          Idat[io] = Idat[i];
+          Idat[i]  = t;
+        }
+      }
+  }
+
+  static void Execute(const FFT_PLAN *Plan, S *Rdat, S *Idat, FFT_STATS *Stats)
+  {
+    const int        N = Plan->N;
+    const int        k = Passes(Plan, Rdat, Idat, Stats);
+    FFT_STAGE_COUNT  c = { 0, 0 };
+    uint64_t         t0 = 0;
+    int              i;
+
+    if(Count) t0 = FFT_Ticks();
+
+    Reorder(Plan, Rdat, Idat);
+    if(!T::Halve && (Plan->Ft_Flag == FT_DIRECT))
+      for(i = 0; i < N; i++)
+      {
+        Rdat[i] = T::Scale(Rdat[i], N);
+        Idat[i] = T::Scale(Idat[i], N);
+      }
+
+    if(Count)
+    {
+      Record(Stats, k, &c, &t0);
+      Stats->Stages = k + 1;
+      Stats->Calls++;
+    }
+  }
+
+  static void Record(FFT_STATS *Stats, int k, FFT_STAGE_COUNT *c, uint64_t *t0)
+  {
+    const uint64_t t1 = FFT_Ticks();
+
+    Stats->Cycles[k]     += t1 - *t0;
+    Stats->Overflow[k]   += c->Overflow;
+    Stats->Saturation[k] += c->Saturation;
+    c->Overflow   = 0;
+    c->Saturation = 0;
+    *t0 = t1;
+  }
+};
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          FFT_ExecutePlanQ15, FFT_ExecutePlanQ31, FFT_ExecutePlanF32.
+// PURPOSE:       In-place transform of Plan->N samples of the given type (see above).
+//
+// PARAMETERS:
+//
+//    FFT_PLAN  *Plan  [in]      - Plan from FFT_GetPlan()
+//    ...       *Rdat  [in, out] - Real part of Input and Output Data
+//    ...       *Idat  [in, out] - Imaginary part of Input and Output Data
+//    FFT_STATS *Stats [in, out] - Counters to add to; NULL - not counted
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool FFT_ExecutePlanQ15(const FFT_PLAN *Plan, int16_t *Rdat, int16_t *Idat, FFT_STATS *Stats);
+
+bool FFT_ExecutePlanQ31(const FFT_PLAN *Plan, qint16 *Rdat, qint16 *Idat, FFT_STATS *Stats);
+
+bool FFT_ExecutePlanF32(const FFT_PLAN *Plan, float *Rdat, float *Idat, FFT_STATS *Stats);
+
+// Selects the engine by Type (FFT_TYPE_Q15, _Q31, _F32), e.g. from a configuration.
+bool FFT_ExecutePlanTyped(const FFT_PLAN *Plan, int Type, void *Rdat, void *Idat, FFT_STATS *Stats);
+
+// Clears the counters. CyclesOnly: true - FFT_COUNT_CYCLES, false - FFT_COUNT_RANGES.
+void FFT_StatsReset(FFT_STATS *Stats, bool CyclesOnly);
+
+// For N = 4 .. 2**FFT_LOGN_MAX runs every type without counters, through the plain
+// engine handed a cleared FFT_STATS (which must stay clear) and counting cycles and
+// ranges, and checks that the results are identical. Q31 must equal FFT_ExecutePlan()
+// in both directions. Q15 and F32 are held to error bounds against the int engine, on
+// input that cannot saturate Q15, with no overflow or saturation counted; full-scale
+// input must be counted. Prints one line; false on any failure.
+bool FFT_TYPE_probe();
+
+#endif
@@ -1,11 +1,33 @@
 #include <stdio.h>
 
 #include "fft_cpp.h"
+#include "fft16.h"
+#include "fft_iq.h"
+#include "fft_type.h"
+#include "fft_real.h"
+#include "fft_sdft.h"
+#include "fft_order.h"
+#include "fft_large.h"
+#include "fft_prune.h"
+#include "search.h"
+#include "stream.h"
 
 int main( int argc, const char* argv[] )
 {
 
  	FFT_probe();
+ 	bool Ok = FFT16_probe();
+ 	Ok = FFT_SMALL_probe() && Ok;
+ 	Ok = FFT_PRUNE_probe() && Ok;
+ 	Ok = FFT_ORDER_probe() && Ok;
+ 	Ok = FFT_LARGE_probe() && Ok;
+ 	Ok = FFT_REAL_probe() && Ok;
+ 	Ok = SDFT_probe() && Ok;
+ 	Ok = FFT_IQ_probe() && Ok;
+ 	Ok = FFT_TYPE_probe() && Ok;
+ 	Ok = SEARCH_probe() && Ok;
+ 	Ok = STREAM_probe() && Ok;
 	
+ 	return Ok ? 0 : 1;
 }
 
@@ -0,0 +1,425 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// FFT acquisition search (see search.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "search.h"
+#include "fft_plan.h"
+
+
+// Off-peak cells are those farther than N >> SEARCH_EXCLUDE_SHIFT samples (at least 1)
+// from the peak, circularly. This covers the main lobe of codes of up to 256 samples
+// per chip.
+#define  SEARCH_EXCLUDE_SHIFT   8
+
+// GPS C/A code: G2 taps of the phase selector for PRN 1 .. 32 (IS-GPS-200, table 3-Ia).
+static const unsigned char CaTaps[32][2] = {
+  {2, 6}, {3, 7}, {4, 8}, {5, 9}, {1, 9}, {2,10}, {1, 8}, {2, 9},
+  {3,10}, {2, 3}, {3, 4}, {5, 6}, {6, 7}, {7, 8}, {8, 9}, {9,10},
+  {1, 4}, {2, 5}, {3, 6}, {4, 7}, {5, 8}, {6, 9}, {1, 3}, {4, 6},
+  {5, 7}, {6, 8}, {7, 9}, {8,10}, {1, 6}, {2, 7}, {3, 8}, {4, 9} };
+
+// Shared by the tasks of one SEARCH_Run().
+typedef struct
+{
+  const SEARCH_CODES *Codes;
+  const FFT_PLAN     *Inverse;
+  const qint16       *Xr;           // Signal spectra, one per sub-bin: SubBins*N.
+  const qint16       *Xi;
+  qint16             *Scratch;      // 2*N per worker.
+  int                 DopplerMax;
+  int                 SubBins;
+
+  double             *Peak;         // Per cell: [code * (2*DopplerMax+1) + Doppler].
+  double             *Noise;
+  int                *Phase;
+} SEARCH_JOB;
+
+
+static qint16 ShiftRound(int64_t x, int s)
+{
+  return (s == 0) ? (qint16)x : (qint16)((x + ((int64_t)1 << (s - 1))) >> s);
+}
+
+// One (code, Doppler) cell: spectrum product, inverse FFT, peak and noise floor.
+static void SearchCell(void *Arg, int Index, int Worker)
+{
+  const SEARCH_JOB   *Job   = (const SEARCH_JOB *)Arg;
+  const SEARCH_CODES *Codes = Job->Codes;
+  const int           N     = Codes->N;
+  const int           Cells = 2 * Job->DopplerMax + 1;
+  const int           Code  = Index / Cells;
+  const int           Dop   = Index % Cells - Job->DopplerMax;
+
+  // Dop = Bin*SubBins + Sub, 0 <= Sub < SubBins: spectrum Sub has the fractional part
+  // mixed out, the whole bins are a rotation by Bin.
+  int Bin = Dop / Job->SubBins;
+  if(Bin * Job->SubBins > Dop) Bin--;
+  const int Sub = Dop - Bin * Job->SubBins;
+
+  const qint16 *Xr = Job->Xr + (size_t)Sub * N;
+  const qint16 *Xi = Job->Xi + (size_t)Sub * N;
+  const qint16 *Cr = Codes->Rspec + (size_t)Code * N;
+  const qint16 *Ci = Codes->Ispec + (size_t)Code * N;
+  qint16       *Yr = Job->Scratch + (size_t)Worker * 2 * N;
+  qint16       *Yi = Yr + N;
+  int           k, m;
+
+  for(k = 0; k < N; k++)
+  {
+    m     = (k + Bin) & (N - 1);
+    Yr[k] = ShiftRound((int64_t)Xr[m] * Cr[k] - (int64_t)Xi[m] * Ci[k], SEARCH_CODE_SHIFT);
+    Yi[k] = ShiftRound((int64_t)Xr[m] * Ci[k] + (int64_t)Xi[m] * Cr[k], SEARCH_CODE_SHIFT);
+  }
+
+  FFT_ExecutePlanRaw(Job->Inverse, Yr, Yi);
+
+  double Best = -1.0, Total = 0.0, Near = 0.0, P;
+  int    Phase = 0;
+
+  for(k = 0; k < N; k++)
+  {
+    P      = (double)Yr[k] * Yr[k] + (double)Yi[k] * Yi[k];
+    Total += P;
+    if(P > Best)
+    {
+      Best  = P;
+      Phase = k;
+    }
+  }
+
+  int Excl = N >> SEARCH_EXCLUDE_SHIFT;
+  if(Excl < 1) Excl = 1;
+  if(2 * Excl + 1 >= N) Excl = (N - 2) / 2;
+
+  for(k = -Excl; k <= Excl; k++)
+  {
+    m     = (Phase + k) & (N - 1);
+    Near += (double)Yr[m] * Yr[m] + (double)Yi[m] * Yi[m];
+  }
+
+  Job->Peak[Index]  = Best;
+  Job->Phase[Index] = Phase;
+  Job->Noise[Index] = (Total - Near) / (N - 2 * Excl - 1);
+}
+
+
+SEARCH_CODES *SEARCH_CreateCodes(const qint16 *Codes, int Count, int N, int LogN)
+{
+  // parameters error check:
+  if((Codes == NULL) || (Count < 1))                    return NULL;
+  if(!NUMBER_IS_2_POW_K(N))                             return NULL;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return NULL;
+  if(N != (1 << LogN))                                  return NULL;
+
+  const FFT_PLAN *Direct = FFT_GetPlan(N, FT_DIRECT);
+  if(Direct == NULL)                                    return NULL;
+
+  SEARCH_CODES *Set = (SEARCH_CODES *)calloc(1, sizeof(SEARCH_CODES));
+  if(Set == NULL)                                       return NULL;
+
+  Set->N     = N;
+  Set->LogN  = LogN;
+  Set->Count = Count;
+  Set->Rspec = (qint16 *)malloc((size_t)Count * N * sizeof(qint16));
+  Set->Ispec = (qint16 *)malloc((size_t)Count * N * sizeof(qint16));
+  if((Set->Rspec == NULL) || (Set->Ispec == NULL))
+  {
+    SEARCH_FreeCodes(Set);
+    return NULL;
+  }
+
+  const int  Shift = LogN - LogN / 2;
+  int        c, n;
+
+  for(c = 0; c < Count; c++)
+  {
+    qint16 *R = Set->Rspec + (size_t)c * N;
+    qint16 *I = Set->Ispec + (size_t)c * N;
+
+    for(n = 0; n < N; n++)
+    {
+      R[n] = Codes[(size_t)c * N + n] * (1 << SEARCH_CODE_SHIFT);
+      I[n] = 0;
+    }
+
+    FFT_ExecutePlanRaw(Direct, R, I);
+
+    for(n = 0; n < N; n++)
+    {
+      R[n] =  ShiftRound(R[n], Shift);
+      I[n] = -ShiftRound(I[n], Shift);
+    }
+  }
+
+  return Set;
+}
+
+
+void SEARCH_FreeCodes(SEARCH_CODES *Codes)
+{
+  if(Codes == NULL) return;
+  free(Codes->Rspec);
+  free(Codes->Ispec);
+  free(Codes);
+}
+
+
+bool SEARCH_Run(POOL *Pool, const SEARCH_CODES *Codes, const qint16 *Rsig, const qint16 *Isig,
+                int DopplerMax, int SubBins, SEARCH_RESULT *Results)
+{
+  // parameters error check:
+  if((Codes == NULL) || (Rsig == NULL) || (Isig == NULL) || (Results == NULL)) return false;
+  if((DopplerMax < 0) || (SubBins < 1))                                         return false;
+
+  const int       N       = Codes->N;
+  const int       Cells   = 2 * DopplerMax + 1;
+  const int       W       = (Pool != NULL) ? POOL_Workers(Pool) : 1;
+  const FFT_PLAN *Direct  = FFT_GetPlan(N, FT_DIRECT);
+  const FFT_PLAN *Inverse = FFT_GetPlan(N, FT_INVERSE);
+  if((Direct == NULL) || (Inverse == NULL))                                     return false;
+  if((int64_t)Codes->Count * Cells > 0x7FFFFFFF)                                return false;
+
+  qint16 *Xr      = (qint16 *)malloc((size_t)SubBins * N * sizeof(qint16));
+  qint16 *Xi      = (qint16 *)malloc((size_t)SubBins * N * sizeof(qint16));
+  qint16 *Scratch = (qint16 *)malloc((size_t)W * 2 * N * sizeof(qint16));
+  double *Peak    = (double *)malloc((size_t)Codes->Count * Cells * sizeof(double));
+  double *Noise   = (double *)malloc((size_t)Codes->Count * Cells * sizeof(double));
+  int    *Phase   = (int *)malloc((size_t)Codes->Count * Cells * sizeof(int));
+  bool    Ok      = (Xr != NULL) && (Xi != NULL) && (Scratch != NULL) &&
+                    (Peak != NULL) && (Noise != NULL) && (Phase != NULL);
+
+  if(Ok)
+  {
+    const int  Shift = Codes->LogN / 2;
+    int        s, n, c, d;
+
+    // Signal spectra: sub-bin s is mixed down by s / SubBins of a bin first.
+    for(s = 0; s < SubBins; s++)
+    {
+      qint16 *R = Xr + (size_t)s * N;
+      qint16 *I = Xi + (size_t)s * N;
+
+      for(n = 0; n < N; n++)
+      {
+        double a  = -2.0 * M_PI * s * n / ((double)N * SubBins);
+        double ca = cos(a), sa = sin(a);
+
+        R[n] = (qint16)floor(Rsig[n] * ca - Isig[n] * sa + 0.5);
+        I[n] = (qint16)floor(Rsig[n] * sa + Isig[n] * ca + 0.5);
+      }
+
+      FFT_ExecutePlanRaw(Direct, R, I);
+
+      for(n = 0; n < N; n++)
+      {
+        R[n] = ShiftRound(R[n], Shift);
+        I[n] = ShiftRound(I[n], Shift);
+      }
+    }
+
+    SEARCH_JOB Job;
+
+    Job.Codes      = Codes;
+    Job.Inverse    = Inverse;
+    Job.Xr         = Xr;
+    Job.Xi         = Xi;
+    Job.Scratch    = Scratch;
+    Job.DopplerMax = DopplerMax;
+    Job.SubBins    = SubBins;
+    Job.Peak       = Peak;
+    Job.Noise      = Noise;
+    Job.Phase      = Phase;
+
+    if(Pool != NULL)
+      POOL_Run(Pool, Codes->Count * Cells, SearchCell, &Job);
+    else
+      for(n = 0; n < Codes->Count * Cells; n++)
+        SearchCell(&Job, n, 0);
+
+    for(c = 0; c < Codes->Count; c++)
+    {
+      int Best = c * Cells;
+
+      for(d = 1; d < Cells; d++)
+        if(Peak[c * Cells + d] > Peak[Best]) Best = c * Cells + d;
+
+      Results[c].CodePhase   = Phase[Best];
+      Results[c].Doppler     = Best - c * Cells - DopplerMax;
+      Results[c].Peak        = Peak[Best];
+      Results[c].PeakToNoise = (Noise[Best] > 0.0) ? Peak[Best] / Noise[Best] : 0.0;
+    }
+  }
+
+  free(Xr);
+  free(Xi);
+  free(Scratch);
+  free(Peak);
+  free(Noise);
+  free(Phase);
+  return Ok;
+}
+
+
+bool SEARCH_GenerateCA(int Prn, qint16 *Code, int N)
+{
+  // parameters error check:
+  if((Code == NULL) || (N < 1))  return false;
+  if((Prn < 1) || (Prn > 32))    return false;
+
+  unsigned char Chip[SEARCH_CA_CHIPS];
+  unsigned char G1[11], G2[11], f1, f2;
+  int           i, b;
+
+  for(b = 1; b <= 10; b++) G1[b] = G2[b] = 1;
+
+  for(i = 0; i < SEARCH_CA_CHIPS; i++)
+  {
+    Chip[i] = G1[10] ^ G2[CaTaps[Prn - 1][0]] ^ G2[CaTaps[Prn - 1][1]];
+
+    f1 = G1[3] ^ G1[10];
+    f2 = G2[2] ^ G2[3] ^ G2[6] ^ G2[8] ^ G2[9] ^ G2[10];
+    for(b = 10; b > 1; b--)
+    {
+      G1[b] = G1[b - 1];
+      G2[b] = G2[b - 1];
+    }
+    G1[1] = f1;
+    G2[1] = f2;
+  }
+
+  for(i = 0; i < N; i++)
+    Code[i] = Chip[(int)((int64_t)i * SEARCH_CA_CHIPS / N)] ? -1 : 1;
+
+  return true;
+}
+
+
+// Uniform (0, 1] from a fixed-seed generator, so the probe is reproducible.
+static double ProbeUniform(uint32_t *State)
+{
+  *State = *State * 1664525u + 1013904223u;
+  return ((*State >> 8) + 1.0) / 16777216.0;
+}
+
+bool SEARCH_probe()
+{
+  const int     LogN = 12, N = 1 << LogN;        // 1 ms at 4.096 MHz.
+  const int     SubBins = 2, DopplerMax = 5 * SubBins;
+  const int     Sats[2][4] = { { 7, 1000,  5, 150 },   // PRN, code phase, Doppler, amplitude
+                               {19, 3000, -6, 100 } };
+  const double  Sigma = 800.0;
+  const double  Threshold = 20.0;                // Peak/noise of a detection.
+
+  qint16        *Codes   = (qint16 *)malloc(32 * N * sizeof(qint16));
+  qint16        *Rsig    = (qint16 *)calloc(N, sizeof(qint16));
+  qint16        *Isig    = (qint16 *)calloc(N, sizeof(qint16));
+  SEARCH_RESULT  Results[32], Single[32];
+  uint32_t       Seed = 1;
+  int            p, n, s;
+
+  if((Codes == NULL) || (Rsig == NULL) || (Isig == NULL))
+  {
+    printf("SEARCH: out of memory\n");
+    free(Codes);
+    free(Rsig);
+    free(Isig);
+    return false;
+  }
+
+  for(p = 0; p < 32; p++)
+    SEARCH_GenerateCA(p + 1, Codes + p * N, N);
+
+  for(n = 0; n < N; n++)
+  {
+    double re, im, u, v;
+
+    // Gaussian noise (Box-Muller) plus the two satellites.
+    u  = sqrt(-2.0 * log(ProbeUniform(&Seed)));
+    v  = 2.0 * M_PI * ProbeUniform(&Seed);
+    re = Sigma * u * cos(v);
+    im = Sigma * u * sin(v);
+
+    for(s = 0; s < 2; s++)
+    {
+      double a = 2.0 * M_PI * Sats[s][2] * n / ((double)N * SubBins);
+      int    c = Codes[(Sats[s][0] - 1) * N + ((n - Sats[s][1]) & (N - 1))];
+
+      re += Sats[s][3] * c * cos(a);
+      im += Sats[s][3] * c * sin(a);
+    }
+
+    re      = floor(re + 0.5);
+    im      = floor(im + 0.5);
+    Rsig[n] = (qint16)((re > SEARCH_SIG_MAX) ? SEARCH_SIG_MAX : (re < -SEARCH_SIG_MAX) ? -SEARCH_SIG_MAX : re);
+    Isig[n] = (qint16)((im > SEARCH_SIG_MAX) ? SEARCH_SIG_MAX : (im < -SEARCH_SIG_MAX) ? -SEARCH_SIG_MAX : im);
+  }
+
+  POOL         *Pool = POOL_Create(0);
+  POOL         *One  = POOL_Create(1);
+  SEARCH_CODES *Set  = SEARCH_CreateCodes(Codes, 32, N, LogN);
+  timespec      t0, t1;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  bool Ok = SEARCH_Run(Pool, Set, Rsig, Isig, DopplerMax, SubBins, Results);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  if(Ok)
+  {
+    printf("SEARCH: N=%d, 32 codes x %d Doppler cells, %d workers: %.1f ms\n",
+           N, 2 * DopplerMax + 1, POOL_Workers(Pool),
+           (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) * 1e-6);
+
+    for(p = 0; p < 32; p++)
+      if(Results[p].PeakToNoise > Threshold)
+        printf("  PRN %2d: code phase %4d, Doppler %+d/%d bin, peak/noise %.1f\n", p + 1,
+               Results[p].CodePhase, Results[p].Doppler, SubBins, Results[p].PeakToNoise);
+
+    // Exactly the two satellites, each in its own cell.
+    for(p = 0; p < 32; p++)
+    {
+      bool Wanted = false, Found = Results[p].PeakToNoise > Threshold;
+
+      for(s = 0; s < 2; s++)
+        if(Sats[s][0] == p + 1)
+        {
+          Wanted = true;
+          Found  = Found && (Results[p].CodePhase == Sats[s][1]) &&
+                   (Results[p].Doppler == Sats[s][2]);
+        }
+
+      if(Found != Wanted)
+      {
+        printf("SEARCH: PRN %d %s\n", p + 1, Wanted ? "not found in its cell" : "false detection");
+        Ok = false;
+      }
+    }
+
+    // The cells do not depend on the worker that runs them.
+    if(!SEARCH_Run(One, Set, Rsig, Isig, DopplerMax, SubBins, Single) ||
+       memcmp(Single, Results, sizeof(Results)))
+    {
+      printf("SEARCH: one worker differs from %d workers\n", POOL_Workers(Pool));
+      Ok = false;
+    }
+  }
+  else
+    printf("SEARCH: search failed\n");
+
+  SEARCH_FreeCodes(Set);
+  POOL_Destroy(One);
+  POOL_Destroy(Pool);
+  free(Codes);
+  free(Rsig);
+  free(Isig);
+  return Ok;
+}
@@ -0,0 +1,115 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// FFT acquisition search: circular correlation of one block of signal with a set of
+// spreading codes over a grid of Doppler shifts.
+//
+// The code spectra conj(FFT(code)) are computed once, by SEARCH_CreateCodes(), and
+// reused by every search. A search transforms the signal once per Doppler sub-bin. Every
+// (code, Doppler) cell then costs one spectrum product and one inverse FFT. A whole-bin
+// Doppler shift is a rotation of the signal spectrum by that many bins, so it needs no
+// new forward transform. The cells run in parallel on a work-stealing pool (fft_pool.h).
+//
+// The Doppler unit is Fs / (N * SubBins): SubBins = 1 gives whole bins (1 kHz for a 1 ms
+// block), SubBins = 2 half-bins, and so on.
+//
+// Fixed point: the signal spectrum is scaled by 2**-(LogN/2) and the code spectrum by
+// 2**-(LogN - LogN/2), so the inverse transform returns the correlation sum itself.
+// Signal samples must stay within +-SEARCH_SIG_MAX.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "fft_cpp.h"
+#include "fft_pool.h"
+
+#define  SEARCH_SIG_MAX      2047   // Largest |re|, |im| of an input sample.
+#define  SEARCH_CODE_SHIFT     12   // Code samples are stored as +-2**SEARCH_CODE_SHIFT.
+#define  SEARCH_CA_CHIPS     1023   // GPS C/A code length.
+
+typedef struct
+{
+  int      N;
+  int      LogN;
+  int      Count;                   // Number of codes.
+  qint16  *Rspec;                   // conj(FFT(code)), Count*N, code c at c*N.
+  qint16  *Ispec;
+} SEARCH_CODES;
+
+typedef struct
+{
+  int      CodePhase;               // Code delay, samples: 0 .. N-1.
+  int      Doppler;                 // -DopplerMax .. DopplerMax, in Fs / (N*SubBins).
+  double   Peak;                    // Correlation power |sum|**2 at the peak.
+  double   PeakToNoise;             // Peak / mean power of the row off the peak.
+} SEARCH_RESULT;
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          SEARCH_CreateCodes.
+// PURPOSE:       Transform and keep the conjugate spectra of Count codes.
+//
+// PARAMETERS:
+//
+//    qint16 *Codes  [in]      - Count codes of N samples, each sample -1, 0 or +1;
+//                               code c at Codes + c*N
+//    int    Count   [in]      - Number of codes, Count >= 1
+//    int    N       [in]      - Block length: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//
+// RETURN VALUE:  the code set (free with SEARCH_FreeCodes), NULL on error.
+//_________________________________________________________________________________________
+
+SEARCH_CODES *SEARCH_CreateCodes(const qint16 *Codes, int Count, int N, int LogN);
+
+void SEARCH_FreeCodes(SEARCH_CODES *Codes);
+
+//_________________________________________________________________________________________
+//
+// NAME:          SEARCH_Run.
+// PURPOSE:       Search one block of signal for every code. Each code gets the cell with
+//                the largest correlation power over all code phases and Doppler shifts.
+//
+// PARAMETERS:
+//
+//    POOL          *Pool       [in]  - Workers for the grid; NULL - run on the caller
+//    SEARCH_CODES  *Codes      [in]  - Code spectra
+//    qint16        *Rsig       [in]  - Real part of the signal, N samples
+//    qint16        *Isig       [in]  - Imaginary part of the signal, N samples
+//    int            DopplerMax [in]  - Doppler range, +-DopplerMax units, >= 0
+//    int            SubBins    [in]  - Doppler units per FFT bin, >= 1
+//    SEARCH_RESULT *Results    [out] - One result per code, Codes->Count entries
+//
+// RETURN VALUE:  false on parameter or memory error, true on success.
+//_________________________________________________________________________________________
+
+bool SEARCH_Run(POOL *Pool, const SEARCH_CODES *Codes, const qint16 *Rsig, const qint16 *Isig,
+                int DopplerMax, int SubBins, SEARCH_RESULT *Results);
+
+//_________________________________________________________________________________________
+//
+// NAME:          SEARCH_GenerateCA.
+// PURPOSE:       One period of the GPS C/A code (Gold code, 1023 chips) sampled to N
+//                samples of +-1.
+//
+// PARAMETERS:
+//
+//    int    Prn     [in]      - Satellite PRN: 1 .. 32
+//    qint16 *Code   [out]     - N samples
+//    int    N       [in]      - Samples per code period
+//
+// RETURN VALUE:  false on parameter error, true on success.
+//_________________________________________________________________________________________
+
+bool SEARCH_GenerateCA(int Prn, qint16 *Code, int N);
+
+// Searches a locally generated signal (two satellites in noise) for all 32 C/A codes
+// and prints the detections and the time of the search. False unless exactly the two
+// satellites are detected, each at its code phase and Doppler, and a single-worker
+// pool gives the same results.
+bool SEARCH_probe();
+
+#endif
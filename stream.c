@@ -0,0 +1,694 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Streaming overlap-save filter (see stream.h).
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "stream.h"
+#include "fft_plan.h"
+#include "fft_order.h"
+
+
+struct STREAM_SOURCE
+{
+  int              Format;
+  int              Bytes;           // Per complex sample.
+  bool             Mapped;
+
+  // Mapped file.
+  const uint8_t   *Map;
+  size_t           Size;
+  size_t           Advised;         // Bytes requested with MADV_WILLNEED so far.
+  size_t           Dropped;         // Bytes released with MADV_DONTNEED so far.
+
+  // Descriptor: the reader thread owns Head, the consumer owns Tail. The bytes in
+  // [Tail, Head) are at Ring[offset & (STREAM_RING - 1)].
+  int              Fd;
+  uint8_t         *Ring;
+  int64_t          Head;
+  int64_t          Tail;
+  bool             Eof;
+  bool             Stop;
+  pthread_t        Reader;
+  pthread_mutex_t  Lock;
+  pthread_cond_t   Cond;
+};
+
+
+static size_t PageDown(size_t x)
+{
+  const size_t Page = (size_t)sysconf(_SC_PAGESIZE);
+  return x - x % Page;
+}
+
+// Fills the ring until end of stream or STREAM_Close(). Cancellation is enabled only
+// around read(), so that STREAM_Close() can stop a reader blocked on an idle pipe.
+static void *ReaderThread(void *Arg)
+{
+  STREAM_SOURCE *Src = (STREAM_SOURCE *)Arg;
+  ssize_t        Got;
+  size_t         At, Len;
+  int            Old;
+
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &Old);
+  pthread_mutex_lock(&Src->Lock);
+
+  while(!Src->Stop)
+  {
+    const int64_t Free = STREAM_RING - (Src->Head - Src->Tail);
+
+    if(Free == 0)
+    {
+      pthread_cond_wait(&Src->Cond, &Src->Lock);
+      continue;
+    }
+
+    At  = (size_t)(Src->Head & (STREAM_RING - 1));
+    Len = STREAM_RING - At;
+    if((int64_t)Len > Free) Len = (size_t)Free;
+
+    pthread_mutex_unlock(&Src->Lock);
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &Old);
+    Got = read(Src->Fd, Src->Ring + At, Len);
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &Old);
+    pthread_mutex_lock(&Src->Lock);
+
+    if(Got > 0)
+      Src->Head += Got;
+    else if((Got < 0) && (errno == EINTR))
+      continue;
+    else
+      Src->Eof = true;
+
+    pthread_cond_broadcast(&Src->Cond);
+    if(Src->Eof) break;
+  }
+
+  pthread_mutex_unlock(&Src->Lock);
+  return NULL;
+}
+
+// Waits until samples up to End are readable or the stream has ended. Returns the
+// number of samples readable from the start, at most End.
+static int64_t Ensure(STREAM_SOURCE *Src, int64_t End)
+{
+  int64_t Avail;
+
+  if(Src->Mapped)
+  {
+    const size_t Want = (size_t)End * Src->Bytes;
+
+    // Keep STREAM_AHEAD bytes in flight beyond the block being filtered.
+    if((Want + STREAM_AHEAD / 2 > Src->Advised) && (Src->Advised < Src->Size))
+    {
+      size_t Len = STREAM_AHEAD;
+
+      if(Src->Advised + Len > Src->Size) Len = Src->Size - Src->Advised;
+      madvise((void *)(Src->Map + Src->Advised), Len, MADV_WILLNEED);
+      Src->Advised += Len;
+    }
+
+    Avail = (int64_t)(Src->Size / Src->Bytes);
+    return (Avail < End) ? Avail : End;
+  }
+
+  pthread_mutex_lock(&Src->Lock);
+  while((Src->Head < End * Src->Bytes) && !Src->Eof)
+    pthread_cond_wait(&Src->Cond, &Src->Lock);
+  Avail = Src->Head / Src->Bytes;
+  pthread_mutex_unlock(&Src->Lock);
+
+  return (Avail < End) ? Avail : End;
+}
+
+// Samples before Start are no longer needed.
+static void Release(STREAM_SOURCE *Src, int64_t Start)
+{
+  if(Start <= 0) return;
+
+  if(Src->Mapped)
+  {
+    const size_t Done = PageDown((size_t)Start * Src->Bytes);
+
+    if(Done >= Src->Dropped + STREAM_AHEAD)
+    {
+      madvise((void *)(Src->Map + Src->Dropped), Done - Src->Dropped, MADV_DONTNEED);
+      Src->Dropped = Done;
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&Src->Lock);
+  Src->Tail = Start * Src->Bytes;
+  pthread_cond_broadcast(&Src->Cond);
+  pthread_mutex_unlock(&Src->Lock);
+}
+
+// Count contiguous samples at Data into the transform buffers.
+static void Widen(const uint8_t *Data, int Format, int Count, qint16 *R, qint16 *I)
+{
+  int n;
+
+  if(Format == STREAM_IQ8)
+  {
+    const int8_t *x = (const int8_t *)Data;
+
+    for(n = 0; n < Count; n++)
+    {
+      R[n] = (qint16)x[2 * n]     * 256;
+      I[n] = (qint16)x[2 * n + 1] * 256;
+    }
+  }
+  else
+  {
+    const int16_t *x = (const int16_t *)Data;
+
+    for(n = 0; n < Count; n++)
+    {
+      R[n] = x[2 * n];
+      I[n] = x[2 * n + 1];
+    }
+  }
+}
+
+// Samples [Start, Start + N) into R, I; those before 0 or from Avail on are zero.
+static void Load(const STREAM_SOURCE *Src, int64_t Start, int64_t Avail, int N, qint16 *R, qint16 *I)
+{
+  int     Lead = 0, Count, Part;
+  size_t  At;
+
+  if(Start < 0)
+  {
+    Lead = (int)-Start;
+    memset(R, 0, Lead * sizeof(qint16));
+    memset(I, 0, Lead * sizeof(qint16));
+  }
+
+  Count = (Avail - Start < N) ? (int)(Avail - Start) : N;
+  if(Count < Lead) Count = Lead;
+
+  if(Src->Mapped)
+    Widen(Src->Map + (size_t)(Start + Lead) * Src->Bytes, Src->Format, Count - Lead, R + Lead, I + Lead);
+  else
+  {
+    // At most two pieces: up to the end of the ring and from its start.
+    At   = (size_t)(((Start + Lead) * Src->Bytes) & (STREAM_RING - 1));
+    Part = (int)((STREAM_RING - At) / Src->Bytes);
+    if(Part > Count - Lead) Part = Count - Lead;
+
+    Widen(Src->Ring + At, Src->Format, Part, R + Lead, I + Lead);
+    Widen(Src->Ring, Src->Format, Count - Lead - Part, R + Lead + Part, I + Lead + Part);
+  }
+
+  memset(R + Count, 0, (N - Count) * sizeof(qint16));
+  memset(I + Count, 0, (N - Count) * sizeof(qint16));
+}
+
+static STREAM_SOURCE *NewSource(int Format)
+{
+  STREAM_SOURCE *Src;
+
+  // parameters error check:
+  if((Format != STREAM_IQ8) && (Format != STREAM_IQ16)) return NULL;
+
+  Src = (STREAM_SOURCE *)calloc(1, sizeof(STREAM_SOURCE));
+  if(Src == NULL)                                       return NULL;
+
+  Src->Format = Format;
+  Src->Bytes  = (Format == STREAM_IQ8) ? 2 : 4;
+  Src->Fd     = -1;
+  return Src;
+}
+
+
+//_________________________________________________________________________________________
+//
+// Sources.
+//_________________________________________________________________________________________
+
+STREAM_SOURCE *STREAM_OpenFile(const char *Path, int Format)
+{
+  STREAM_SOURCE *Src;
+  struct stat    St;
+  int            Fd;
+
+  // parameters error check:
+  if(Path == NULL)                                      return NULL;
+
+  Src = NewSource(Format);
+  if(Src == NULL)                                       return NULL;
+
+  Fd = open(Path, O_RDONLY);
+  if((Fd < 0) || (fstat(Fd, &St) != 0))
+  {
+    if(Fd >= 0) close(Fd);
+    free(Src);
+    return NULL;
+  }
+
+  Src->Mapped = true;
+  Src->Size   = (size_t)St.st_size;
+  if(Src->Size > 0)
+  {
+    void *Map = mmap(NULL, Src->Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+
+    if(Map == MAP_FAILED)
+    {
+      close(Fd);
+      free(Src);
+      return NULL;
+    }
+    Src->Map = (const uint8_t *)Map;
+    madvise(Map, Src->Size, MADV_SEQUENTIAL);
+  }
+
+  // The mapping keeps the file referenced.
+  close(Fd);
+  return Src;
+}
+
+STREAM_SOURCE *STREAM_OpenFd(int Fd, int Format)
+{
+  STREAM_SOURCE *Src;
+
+  // parameters error check:
+  if(Fd < 0)                                            return NULL;
+
+  Src = NewSource(Format);
+  if(Src == NULL)                                       return NULL;
+
+  Src->Fd   = Fd;
+  Src->Ring = (uint8_t *)malloc(STREAM_RING);
+  if(Src->Ring == NULL)
+  {
+    free(Src);
+    return NULL;
+  }
+
+  pthread_mutex_init(&Src->Lock, NULL);
+  pthread_cond_init(&Src->Cond, NULL);
+  if(pthread_create(&Src->Reader, NULL, ReaderThread, Src) != 0)
+  {
+    pthread_mutex_destroy(&Src->Lock);
+    pthread_cond_destroy(&Src->Cond);
+    free(Src->Ring);
+    free(Src);
+    return NULL;
+  }
+  return Src;
+}
+
+void STREAM_Close(STREAM_SOURCE *Src)
+{
+  if(Src == NULL) return;
+
+  if(Src->Mapped)
+  {
+    if(Src->Map != NULL) munmap((void *)Src->Map, Src->Size);
+  }
+  else
+  {
+    pthread_mutex_lock(&Src->Lock);
+    Src->Stop = true;
+    pthread_cond_broadcast(&Src->Cond);
+    pthread_mutex_unlock(&Src->Lock);
+
+    pthread_cancel(Src->Reader);
+    pthread_join(Src->Reader, NULL);
+    pthread_mutex_destroy(&Src->Lock);
+    pthread_cond_destroy(&Src->Cond);
+    free(Src->Ring);
+  }
+  free(Src);
+}
+
+
+//_________________________________________________________________________________________
+//
+// Filter.
+//_________________________________________________________________________________________
+
+STREAM_FILTER *STREAM_CreateFilter(const qint16 *Hr, const qint16 *Hi, int Taps, int N, int LogN)
+{
+  const FFT_PLAN *Plan;
+  STREAM_FILTER  *Filter;
+
+  // parameters error check:
+  if(Hr == NULL)                                        return NULL;
+  if(!NUMBER_IS_2_POW_K(N))                             return NULL;
+  if((LogN < 2) || (LogN > FFT_LOGN_MAX))               return NULL;
+  if(N != (1 << LogN))                                  return NULL;
+  if((Taps < 1) || (Taps > N / 2))                      return NULL;
+
+  Plan = FFT_GetPlan(N, FT_DIRECT);
+  if(Plan == NULL)                                      return NULL;
+
+  Filter = (STREAM_FILTER *)malloc(sizeof(STREAM_FILTER));
+  if(Filter == NULL)                                    return NULL;
+
+  Filter->N    = N;
+  Filter->LogN = LogN;
+  Filter->Taps = Taps;
+  Filter->Hr   = (qint16 *)calloc(N, sizeof(qint16));
+  Filter->Hi   = (qint16 *)calloc(N, sizeof(qint16));
+  if((Filter->Hr == NULL) || (Filter->Hi == NULL))
+  {
+    STREAM_FreeFilter(Filter);
+    return NULL;
+  }
+
+  memcpy(Filter->Hr, Hr, Taps * sizeof(qint16));
+  if(Hi != NULL) memcpy(Filter->Hi, Hi, Taps * sizeof(qint16));
+
+  // Unscaled and bit-reversed, the order the blocks are in after their direct transform.
+  FFT_ExecutePlanDif(Plan, Filter->Hr, Filter->Hi);
+  return Filter;
+}
+
+void STREAM_FreeFilter(STREAM_FILTER *Filter)
+{
+  if(Filter == NULL) return;
+
+  free(Filter->Hr);
+  free(Filter->Hi);
+  free(Filter);
+}
+
+bool STREAM_LowPass(qint16 *Taps, int Count, double Cutoff)
+{
+  double *h, Sum = 0.0;
+  int     m;
+
+  // parameters error check:
+  if((Taps == NULL) || (Count < 1))                     return false;
+  if((Cutoff <= 0.0) || (Cutoff > 0.5))                 return false;
+
+  h = (double *)malloc(Count * sizeof(double));
+  if(h == NULL)                                         return false;
+
+  for(m = 0; m < Count; m++)
+  {
+    const double t = m - (Count - 1) / 2.0;
+    const double w = (Count > 1) ? 0.54 - 0.46 * cos(2.0 * M_PI * m / (Count - 1)) : 1.0;
+
+    h[m] = ((t == 0.0) ? 2.0 * Cutoff : sin(2.0 * M_PI * Cutoff * t) / (M_PI * t)) * w;
+    Sum += h[m];
+  }
+  for(m = 0; m < Count; m++)
+    Taps[m] = (qint16)floor(h[m] / Sum * Q15_ONE + 0.5);
+
+  free(h);
+  return true;
+}
+
+
+//_________________________________________________________________________________________
+//
+// Overlap-save.
+//
+// A block of N samples gives N - Taps + 1 outputs. The direct transform is raw, with
+// growth of up to N. The spectral product is scaled by 2**-(15 + LogN/2) and the inverse
+// output by 2**-(LogN - LogN/2), so that the scaling splits between the two transforms
+// instead of truncating the spectrum of a low-level int8 signal to nothing.
+//_________________________________________________________________________________________
+
+int64_t STREAM_Run(STREAM_SOURCE *Src, const STREAM_FILTER *Filter, STREAM_SINK Sink, void *Arg)
+{
+  const FFT_PLAN *Direct, *Inverse;
+  qint16         *R, *I;
+
+  // parameters error check:
+  if((Src == NULL) || (Filter == NULL) || (Sink == NULL)) return -1;
+  if((int64_t)Filter->N * Src->Bytes * 2 > STREAM_RING)   return -1;
+
+  Direct  = FFT_GetPlan(Filter->N, FT_DIRECT);
+  Inverse = FFT_GetPlan(Filter->N, FT_INVERSE);
+  if((Direct == NULL) || (Inverse == NULL))               return -1;
+
+  R = (qint16 *)malloc(Filter->N * sizeof(qint16));
+  I = (qint16 *)malloc(Filter->N * sizeof(qint16));
+  if((R == NULL) || (I == NULL))
+  {
+    free(R);
+    free(I);
+    return -1;
+  }
+
+  const int  N     = Filter->N;
+  const int  Keep  = Filter->Taps - 1;
+  const int  Step  = N - Keep;
+  const int  S1    = 15 + Filter->LogN / 2;
+  const int  S2    = Filter->LogN - Filter->LogN / 2;
+  int64_t    Out   = 0;
+  int64_t    Avail;
+  int        Count, k, n;
+
+  for(;;)
+  {
+    const int64_t Start = Out - Keep;
+
+    Avail = Ensure(Src, Start + N);
+    if(Avail <= Out) break;
+
+    Load(Src, Start, Avail, N, R, I);
+    FFT_ExecutePlanDif(Direct, R, I);
+
+    for(k = 0; k < N; k++)
+    {
+      const int64_t xr = R[k], xi = I[k];
+      const int64_t hr = Filter->Hr[k], hi = Filter->Hi[k];
+
+      R[k] = (qint16)((xr * hr - xi * hi + (1LL << (S1 - 1))) >> S1);
+      I[k] = (qint16)((xr * hi + xi * hr + (1LL << (S1 - 1))) >> S1);
+    }
+
+    FFT_ExecutePlanBitRev(Inverse, R, I);
+
+    Count = (Avail - Out < Step) ? (int)(Avail - Out) : Step;
+    for(n = Keep; n < Keep + Count; n++)
+    {
+      R[n] = (R[n] + (1 << (S2 - 1))) >> S2;
+      I[n] = (I[n] + (1 << (S2 - 1))) >> S2;
+    }
+
+    Sink(Arg, R + Keep, I + Keep, Count, Out);
+    Out += Count;
+    Release(Src, Out - Keep);
+
+    if(Count < Step) break;
+  }
+
+  free(R);
+  free(I);
+  return Out;
+}
+
+
+//_________________________________________________________________________________________
+//
+// Probe.
+//_________________________________________________________________________________________
+
+typedef struct
+{
+  qint16  *R;
+  qint16  *I;
+} PROBE_OUT;
+
+static void ProbeSink(void *Arg, const qint16 *Rout, const qint16 *Iout, int Count, int64_t Position)
+{
+  PROBE_OUT *Out = (PROBE_OUT *)Arg;
+
+  memcpy(Out->R + Position, Rout, Count * sizeof(qint16));
+  memcpy(Out->I + Position, Iout, Count * sizeof(qint16));
+}
+
+typedef struct
+{
+  int            Fd;
+  const int16_t *Data;
+  size_t         Size;
+} PROBE_WRITER;
+
+static void *ProbeWriter(void *Arg)
+{
+  PROBE_WRITER *W = (PROBE_WRITER *)Arg;
+  size_t        Done = 0;
+  ssize_t       Got;
+
+  while(Done < W->Size)
+  {
+    Got = write(W->Fd, (const uint8_t *)W->Data + Done, W->Size - Done);
+    if(Got <= 0) break;
+    Done += Got;
+  }
+  close(W->Fd);
+  return NULL;
+}
+
+static double ProbeSeconds(const timespec *t0, const timespec *t1)
+{
+  return (t1->tv_sec - t0->tv_sec) + (t1->tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+bool STREAM_probe()
+{
+  const int      LogN = 12, N = 1 << LogN, Taps = 63;
+  const int      Len = 1 << 20;
+  const double   SnrMin = 60.0;                 // dB against direct convolution.
+  char           Path[] = "/tmp/stream_probe_XXXXXX";
+  int16_t       *Iq   = (int16_t *)malloc((size_t)Len * 2 * sizeof(int16_t));
+  qint16        *Rout = (qint16 *)calloc(Len, sizeof(qint16));
+  qint16        *Iout = (qint16 *)calloc(Len, sizeof(qint16));
+  qint16         h[Taps];
+  uint32_t       Seed = 1;
+  int            n, m, Fd;
+
+  if((Iq == NULL) || (Rout == NULL) || (Iout == NULL) || !STREAM_LowPass(h, Taps, 0.1))
+  {
+    printf("STREAM: out of memory\n");
+    free(Iq);
+    free(Rout);
+    free(Iout);
+    return false;
+  }
+
+  // A tone in the pass band, one in the stop band and uniform noise.
+  for(n = 0; n < Len; n++)
+  {
+    double re, im;
+
+    Seed  = Seed * 1664525u + 1013904223u;
+    re    = 8000.0 * cos(0.05 * 2.0 * M_PI * n) + 8000.0 * cos(0.3 * 2.0 * M_PI * n);
+    im    = 8000.0 * sin(0.05 * 2.0 * M_PI * n) + 8000.0 * sin(0.3 * 2.0 * M_PI * n);
+    re   += (int)((Seed >> 16) & 0xFFF) - 2048;
+    im   += (int)((Seed >>  4) & 0xFFF) - 2048;
+    Iq[2 * n]     = (int16_t)floor(re + 0.5);
+    Iq[2 * n + 1] = (int16_t)floor(im + 0.5);
+  }
+
+  STREAM_FILTER *Filter = STREAM_CreateFilter(h, NULL, Taps, N, LogN);
+  bool           Ok     = false;
+
+  Fd = mkstemp(Path);
+  if((Fd >= 0) && (Filter != NULL))
+    Ok = (write(Fd, Iq, (size_t)Len * 4) == (ssize_t)Len * 4);
+  if(Fd >= 0)
+    close(Fd);
+  if(!Ok)
+    printf("STREAM: cannot set up the filter or %s\n", Path);
+
+  const char *Name[2] = { "mmap", "pipe" };
+  qint16     *Rfirst  = NULL;
+  int         Source;
+
+  for(Source = 0; Ok && (Source < 2); Source++)
+  {
+    STREAM_SOURCE *Src = NULL;
+    PROBE_WRITER   Writer;
+    pthread_t      Thread;
+    int            Pipe[2];
+    timespec       t0, t1;
+
+    if(Source == 0)
+      Src = STREAM_OpenFile(Path, STREAM_IQ16);
+    else if(pipe(Pipe) == 0)
+    {
+      Writer.Fd   = Pipe[1];
+      Writer.Data = Iq;
+      Writer.Size = (size_t)Len * 4;
+      Src = STREAM_OpenFd(Pipe[0], STREAM_IQ16);
+      if((Src == NULL) || (pthread_create(&Thread, NULL, ProbeWriter, &Writer) != 0))
+      {
+        STREAM_Close(Src);
+        close(Pipe[0]);
+        close(Pipe[1]);
+        Src = NULL;
+      }
+    }
+    if(Src == NULL)
+    {
+      printf("STREAM: cannot open the %s source\n", Name[Source]);
+      Ok = false;
+      break;
+    }
+
+    PROBE_OUT Out = { Rout, Iout };
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int64_t Done = STREAM_Run(Src, Filter, ProbeSink, &Out);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    STREAM_Close(Src);
+    if(Source == 1)
+    {
+      pthread_join(Thread, NULL);
+      close(Pipe[0]);
+    }
+
+    // Error against direct convolution in double.
+    double Sig = 0.0, Err = 0.0;
+
+    for(n = 0; n < Len; n++)
+    {
+      double re = 0.0, im = 0.0;
+
+      for(m = 0; (m < Taps) && (m <= n); m++)
+      {
+        re += h[m] * (double)Iq[2 * (n - m)];
+        im += h[m] * (double)Iq[2 * (n - m) + 1];
+      }
+      re  /= 32768.0;
+      im  /= 32768.0;
+      Sig += re * re + im * im;
+      Err += (Rout[n] - re) * (Rout[n] - re) + (Iout[n] - im) * (Iout[n] - im);
+    }
+
+    const double Snr  = 10.0 * log10(Sig / (Err > 0.0 ? Err : 1e-30));
+    bool         Same = true;
+
+    if(Source == 0)
+    {
+      Rfirst = (qint16 *)malloc((size_t)Len * 2 * sizeof(qint16));
+      if(Rfirst != NULL)
+      {
+        memcpy(Rfirst, Rout, Len * sizeof(qint16));
+        memcpy(Rfirst + Len, Iout, Len * sizeof(qint16));
+      }
+      else
+        Ok = false;
+    }
+    else
+      Same = (memcmp(Rfirst, Rout, Len * sizeof(qint16)) == 0) &&
+             (memcmp(Rfirst + Len, Iout, Len * sizeof(qint16)) == 0);
+
+    printf("STREAM: %s, N=%d, %d taps, %d samples: %lld out, %.1f MS/s, SNR %.1f dB%s\n",
+           Name[Source], N, Taps, Len, (long long)Done, Len / ProbeSeconds(&t0, &t1) * 1e-6,
+           Snr, (Source == 0) ? "" : Same ? ", same as mmap" : ", DIFFERS from mmap");
+
+    if((Done != Len) || (Snr < SnrMin) || !Same)
+      Ok = false;
+  }
+
+  if(Fd >= 0) unlink(Path);
+  STREAM_FreeFilter(Filter);
+  free(Rfirst);
+  free(Iq);
+  free(Rout);
+  free(Iout);
+  return Ok;
+}
@@ -0,0 +1,137 @@
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+//
+// Streaming FIR filter by overlap-save over IQ recordings.
+//
+// A source is either a memory-mapped file (any size) or a file descriptor, e.g. stdin,
+// drained by a reader thread into a ring buffer. Samples are interleaved I/Q pairs of
+// int8 or int16 in native byte order. Each block of N samples is loaded straight from
+// the mapping or the ring into the transform buffers, widening and deinterleaving as it
+// goes; no other copy of the input is made. int8 samples are scaled by 256, so both
+// formats produce output on the int16 scale.
+//
+// A block is the last Taps-1 samples of the previous one plus N-Taps+1 new samples. It
+// goes through:
+//    direct FFT -> product with the filter spectrum -> inverse FFT.
+// The first Taps-1 outputs are dropped, and the rest are y[n] = sum h[m] * x[n-m], with
+// x[n] = 0 before the start. Both transforms run in bit-reversed spectrum order
+// (FFT_ExecutePlanBitRev), so no reorder pass is needed.
+//
+// I/O overlaps with compute. A mapped file gets MADV_WILLNEED STREAM_AHEAD bytes ahead of
+// the block being filtered, and the consumed pages are released behind it. A descriptor is
+// read by its own thread into the ring while blocks are filtered.
+//_________________________________________________________________________________________
+//_________________________________________________________________________________________
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+
+#include "fft_cpp.h"
+
+#define  STREAM_IQ8            1          // int8 I, int8 Q.
+#define  STREAM_IQ16           2          // int16 I, int16 Q.
+
+#define  STREAM_AHEAD     (8 << 20)       // Bytes of a mapped file requested ahead.
+#define  STREAM_RING      (4 << 20)       // Ring buffer of a descriptor source, bytes.
+
+typedef struct STREAM_SOURCE STREAM_SOURCE;
+
+typedef struct
+{
+  int      N;
+  int      LogN;
+  int      Taps;
+  qint16  *Hr;                            // Filter spectrum, bit-reversed order.
+  qint16  *Hi;
+} STREAM_FILTER;
+
+// Receives Count filtered samples starting at sample number Position. The arrays are
+// the transform buffers and are valid only during the call.
+typedef void (*STREAM_SINK)(void *Arg, const qint16 *Rout, const qint16 *Iout, int Count,
+                            int64_t Position);
+
+
+//_________________________________________________________________________________________
+//
+// NAME:          STREAM_OpenFile.
+// PURPOSE:       Maps an IQ recording read-only.
+//
+// PARAMETERS:
+//
+//    char   *Path   [in]      - File name
+//    int    Format  [in]      - STREAM_IQ8 or STREAM_IQ16
+//
+// RETURN VALUE:  the source, NULL on error.
+//_________________________________________________________________________________________
+
+STREAM_SOURCE *STREAM_OpenFile(const char *Path, int Format);
+
+//_________________________________________________________________________________________
+//
+// NAME:          STREAM_OpenFd.
+// PURPOSE:       Reads an IQ stream from a descriptor (pipe, socket, stdin) through a
+//                ring buffer of STREAM_RING bytes filled by a reader thread.
+//
+// PARAMETERS:
+//
+//    int    Fd      [in]      - Open descriptor; not closed by STREAM_Close
+//    int    Format  [in]      - STREAM_IQ8 or STREAM_IQ16
+//
+// RETURN VALUE:  the source, NULL on error.
+//_________________________________________________________________________________________
+
+STREAM_SOURCE *STREAM_OpenFd(int Fd, int Format);
+
+void STREAM_Close(STREAM_SOURCE *Src);
+
+//_________________________________________________________________________________________
+//
+// NAME:          STREAM_CreateFilter.
+// PURPOSE:       Transforms the taps of a complex FIR filter for blocks of N samples.
+//
+// PARAMETERS:
+//
+//    qint16 *Hr     [in]      - Real parts of the taps, Q15
+//    qint16 *Hi     [in]      - Imaginary parts of the taps, Q15; NULL - real filter
+//    int    Taps    [in]      - Number of taps: 1 .. N/2
+//    int    N       [in]      - Block length: 4, 8, ... 2**FFT_LOGN_MAX
+//    int    LogN    [in]      - Logarithm2(N)
+//
+// RETURN VALUE:  the filter (free with STREAM_FreeFilter), NULL on error.
+//_________________________________________________________________________________________
+
+STREAM_FILTER *STREAM_CreateFilter(const qint16 *Hr, const qint16 *Hi, int Taps, int N, int LogN);
+
+void STREAM_FreeFilter(STREAM_FILTER *Filter);
+
+//_________________________________________________________________________________________
+//
+// NAME:          STREAM_Run.
+// PURPOSE:       Filters the whole source. One output sample per input sample goes to
+//                Sink, in order.
+//
+// PARAMETERS:
+//
+//    STREAM_SOURCE *Src    [in]   - Source from STREAM_OpenFile or STREAM_OpenFd
+//    STREAM_FILTER *Filter [in]   - Filter from STREAM_CreateFilter
+//    STREAM_SINK    Sink   [in]   - Output callback
+//    void          *Arg    [in]   - Passed to Sink
+//
+// RETURN VALUE:  number of samples filtered, -1 on parameter or memory error.
+//_________________________________________________________________________________________
+
+int64_t STREAM_Run(STREAM_SOURCE *Src, const STREAM_FILTER *Filter, STREAM_SINK Sink, void *Arg);
+
+// Windowed-sinc (Hamming) low-pass taps in Q15 with unity DC gain; Cutoff is a fraction
+// of the sample rate, 0 .. 0.5.
+bool STREAM_LowPass(qint16 *Taps, int Count, double Cutoff);
+
+// Writes a synthetic int16 recording to a temporary file, replays it through a mapping
+// and through a pipe, checks both against direct convolution and prints the throughput.
+// False on a setup error, a short output, an SNR below 60 dB or any difference between
+// the two sources.
+bool STREAM_probe();
+
+#endif